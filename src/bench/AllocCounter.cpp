@@ -0,0 +1,110 @@
+#include "bench/Bench.h"
+
+#include <cstdlib>
+#include <new>
+
+// Counting replacements for the global allocation functions. They only
+// exist in the bench binary; the app keeps the standard ones.
+
+namespace {
+
+// Per thread, so a worker thread's allocations never show up in a render
+// loop measurement.
+thread_local uint64_t g_allocations = 0;
+
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+SDL_malloc_func g_sdl_malloc = nullptr;
+SDL_calloc_func g_sdl_calloc = nullptr;
+SDL_realloc_func g_sdl_realloc = nullptr;
+SDL_free_func g_sdl_free = nullptr;
+
+void* SDLCALL CountingSdlMalloc(size_t size) {
+    ++g_allocations;
+    return g_sdl_malloc(size);
+}
+
+void* SDLCALL CountingSdlCalloc(size_t nmemb, size_t size) {
+    ++g_allocations;
+    return g_sdl_calloc(nmemb, size);
+}
+
+void* SDLCALL CountingSdlRealloc(void* mem, size_t size) {
+    ++g_allocations;
+    return g_sdl_realloc(mem, size);
+}
+#endif
+
+void* CountedAlloc(std::size_t size) {
+    ++g_allocations;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    return CountedAlloc(size);
+}
+
+void* operator new[](std::size_t size) {
+    return CountedAlloc(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    ++g_allocations;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    ++g_allocations;
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+namespace Bench {
+
+uint64_t AllocationCount() {
+    return g_allocations;
+}
+
+bool InstallSdlAllocationCounter() {
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+    if (g_sdl_malloc) {
+        return true;
+    }
+    SDL_GetMemoryFunctions(&g_sdl_malloc, &g_sdl_calloc, &g_sdl_realloc, &g_sdl_free);
+    // Frees go straight to the original function, so memory SDL allocated
+    // before the switch is released correctly.
+    return SDL_SetMemoryFunctions(CountingSdlMalloc, CountingSdlCalloc, CountingSdlRealloc, g_sdl_free) == 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace Bench
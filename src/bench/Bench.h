@@ -0,0 +1,97 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/EventSnapshot.h"
+#include "db/MetaSnapshot.h"
+#include "render/FontRegistry.h"
+#include "util/PerfCounters.h"
+
+class EventStore;
+class LayeredView;
+class RollingHistogram;
+class TextRenderer;
+
+namespace Bench {
+
+struct Resolution {
+    int width = 0;
+    int height = 0;
+};
+
+// Offscreen software renderer drawing into a plain surface; needs no display.
+struct HeadlessTarget {
+    SDL_Surface* surface = nullptr;
+    SDL_Renderer* renderer = nullptr;
+};
+
+bool InitHeadlessSdl();
+void ShutdownHeadlessSdl();
+bool CreateHeadlessTarget(const Resolution& size, HeadlessTarget* out);
+void DestroyHeadlessTarget(HeadlessTarget* target);
+
+// The faces main.cpp registers, at the same sizes.
+struct BenchFonts {
+    FontHandle time;
+    FontHandle date;
+    FontHandle info;
+    FontHandle header;
+    FontHandle day;
+    FontHandle agenda;
+    FontHandle weather_temp;
+};
+
+BenchFonts RegisterFonts(FontRegistry* registry, const std::string& path);
+
+// What the sync threads publish in the app; the views read only these.
+struct BenchSnapshots {
+    EventSnapshotSlot events;
+    MetaSnapshotSlot sync_status;
+    MetaSnapshotSlot weather;
+};
+
+// Constructs the view called `name` ("clock", "calendar" or "weather") the
+// way main.cpp does; nullptr for an unknown name.
+std::unique_ptr<LayeredView> MakeView(const std::string& name,
+                                      SDL_Renderer* renderer,
+                                      TextRenderer* text,
+                                      const BenchFonts& fonts,
+                                      const BenchSnapshots& snapshots,
+                                      const std::string& sprite_dir,
+                                      const std::string& weather_sprite_dir);
+
+// Fills `store` with the sample calendar plus a representative weather
+// forecast, so every view has real content to render, and publishes it to
+// `snapshots` as the sync threads would.
+bool SeedStore(EventStore* store, BenchSnapshots* snapshots, int64_t now_ts);
+
+// Parses "800x480"; returns false on malformed input.
+bool ParseResolution(const std::string& text, Resolution* out);
+
+void PrintTableHeader();
+void PrintTableRow(const std::string& label,
+                   const std::string& phase,
+                   const RollingHistogram& ms,
+                   const PerfCounters::Snapshot& totals,
+                   size_t frames,
+                   size_t cache_hits);
+
+int RunRenderBench(const std::vector<std::string>& args);
+int RunTextBench(const std::vector<std::string>& args);
+int RunSteadyBench(const std::vector<std::string>& args);
+int RunDbBench(const std::vector<std::string>& args);
+
+// Heap allocations made by the calling thread so far: operator new in the
+// bench binary, plus SDL's own allocations once
+// InstallSdlAllocationCounter() has run. Plain malloc from other C
+// libraries (SQLite, FreeType) is not seen.
+uint64_t AllocationCount();
+// Routes SDL_malloc and friends through the counter. Call before SDL_Init.
+bool InstallSdlAllocationCounter();
+
+} // namespace Bench
@@ -0,0 +1,212 @@
+#include "bench/Bench.h"
+
+#include "db/EventSnapshot.h"
+#include "db/EventStore.h"
+#include "db/MetaSnapshot.h"
+#include "render/FrameProfiler.h"
+#include "render/TextRenderer.h"
+#include "services/CalendarSyncService.h"
+#include "services/WeatherSyncService.h"
+#include "views/CalendarView.h"
+#include "views/ClockView.h"
+#include "views/WeatherView.h"
+
+#include <SDL_image.h>
+#include <SDL_ttf.h>
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+namespace Bench {
+
+namespace {
+
+std::string FormatLocal(int64_t ts, const char* format) {
+    std::time_t t = static_cast<std::time_t>(ts);
+    std::tm tm{};
+    localtime_r(&t, &tm);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), format, &tm);
+    return buf;
+}
+
+} // namespace
+
+bool InitHeadlessSdl() {
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
+        return false;
+    }
+    if (TTF_Init() != 0) {
+        std::cerr << "TTF_Init failed: " << TTF_GetError() << "\n";
+        SDL_Quit();
+        return false;
+    }
+    if ((IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0) {
+        std::cerr << "IMG_Init failed: " << IMG_GetError() << "\n";
+    }
+    return true;
+}
+
+void ShutdownHeadlessSdl() {
+    IMG_Quit();
+    TTF_Quit();
+    SDL_Quit();
+}
+
+bool CreateHeadlessTarget(const Resolution& size, HeadlessTarget* out) {
+    out->surface = SDL_CreateRGBSurfaceWithFormat(0, size.width, size.height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!out->surface) {
+        std::cerr << "SDL_CreateRGBSurfaceWithFormat failed: " << SDL_GetError() << "\n";
+        return false;
+    }
+    out->renderer = SDL_CreateSoftwareRenderer(out->surface);
+    if (!out->renderer) {
+        std::cerr << "SDL_CreateSoftwareRenderer failed: " << SDL_GetError() << "\n";
+        SDL_FreeSurface(out->surface);
+        out->surface = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void DestroyHeadlessTarget(HeadlessTarget* target) {
+    if (target->renderer) {
+        SDL_DestroyRenderer(target->renderer);
+        target->renderer = nullptr;
+    }
+    if (target->surface) {
+        SDL_FreeSurface(target->surface);
+        target->surface = nullptr;
+    }
+}
+
+BenchFonts RegisterFonts(FontRegistry* registry, const std::string& path) {
+    BenchFonts fonts;
+    fonts.time = registry->Register(path, 80);
+    fonts.date = registry->Register(path, 18);
+    fonts.info = registry->Register(path, 16);
+    fonts.header = registry->Register(path, 18);
+    fonts.day = registry->Register(path, 16);
+    fonts.agenda = registry->Register(path, 16);
+    fonts.weather_temp = registry->Register(path, 50);
+    return fonts;
+}
+
+std::unique_ptr<LayeredView> MakeView(const std::string& name,
+                                      SDL_Renderer* renderer,
+                                      TextRenderer* text,
+                                      const BenchFonts& fonts,
+                                      const BenchSnapshots& snapshots,
+                                      const std::string& sprite_dir,
+                                      const std::string& weather_sprite_dir) {
+    if (name == "clock") {
+        return std::make_unique<ClockView>(renderer, text, fonts.time, fonts.date, fonts.info, &snapshots.events,
+                                           &snapshots.sync_status, &snapshots.weather, sprite_dir);
+    }
+    if (name == "calendar") {
+        return std::make_unique<CalendarView>(renderer, text, fonts.header, fonts.day, fonts.agenda, &snapshots.events,
+                                              &snapshots.sync_status);
+    }
+    if (name == "weather") {
+        return std::make_unique<WeatherView>(renderer, text, fonts.header, fonts.info, fonts.weather_temp, &snapshots.weather,
+                                             weather_sprite_dir);
+    }
+    return nullptr;
+}
+
+bool SeedStore(EventStore* store, BenchSnapshots* snapshots, int64_t now_ts) {
+    if (!store->InsertSampleEvents(now_ts)) {
+        return false;
+    }
+    std::shared_ptr<const EventSnapshot> events = EventSnapshot::Load(store);
+    if (!events) {
+        return false;
+    }
+    snapshots->events.Publish(std::move(events));
+
+    store->SetMeta("last_sync_status", "ok");
+    store->SetMeta("last_sync_ts", std::to_string(now_ts));
+    store->SetMeta("last_sync_error", "");
+
+    nlohmann::json hourly = nlohmann::json::array();
+    for (int i = 0; i < 24; ++i) {
+        nlohmann::json item;
+        item["time"] = FormatLocal(now_ts + i * 3600, "%Y-%m-%dT%H:00");
+        item["temp_c"] = 12.0 + (i % 8);
+        item["code"] = (i % 3 == 0) ? 3 : 1;
+        item["is_day"] = (i > 6 && i < 19) ? 1 : 0;
+        hourly.push_back(std::move(item));
+    }
+    nlohmann::json daily = nlohmann::json::array();
+    for (int i = 0; i < 7; ++i) {
+        nlohmann::json item;
+        item["date"] = FormatLocal(now_ts + i * 86400, "%Y-%m-%d");
+        item["max_c"] = 18.0 + i;
+        item["min_c"] = 8.0 + i;
+        item["code"] = (i % 2 == 0) ? 61 : 2;
+        daily.push_back(std::move(item));
+    }
+
+    store->SetMeta("weather_status", "ok");
+    store->SetMeta("weather_temp_c", "14.5");
+    store->SetMeta("weather_code", "2");
+    store->SetMeta("weather_is_day", "1");
+    store->SetMeta("weather_summary", "Partly cloudy");
+    store->SetMeta("weather_wind_kmh", "11.2");
+    store->SetMeta("weather_error", "");
+    store->SetMeta("weather_last_sync_ts", std::to_string(now_ts));
+    if (!store->SetMeta("weather_hourly_json", hourly.dump()) ||
+        !store->SetMeta("weather_daily_json", daily.dump())) {
+        return false;
+    }
+    snapshots->sync_status.Publish(MetaSnapshot::Load(store, CalendarSyncService::StatusMetaKeys()));
+    snapshots->weather.Publish(MetaSnapshot::Load(store, WeatherSyncService::MetaKeys()));
+    return true;
+}
+
+bool ParseResolution(const std::string& text, Resolution* out) {
+    int w = 0;
+    int h = 0;
+    char sep = 0;
+    std::istringstream in(text);
+    if (!(in >> w >> sep >> h) || (sep != 'x' && sep != 'X') || !in.eof() || w <= 0 || h <= 0 ||
+        w > 8192 || h > 8192) {
+        return false;
+    }
+    out->width = w;
+    out->height = h;
+    return true;
+}
+
+void PrintTableHeader() {
+    std::cout << std::left << std::setw(22) << "case" << std::setw(8) << "phase" << std::right
+              << std::setw(7) << "frames" << std::setw(9) << "p50 ms" << std::setw(9) << "p95 ms"
+              << std::setw(9) << "max ms" << std::setw(10) << "sql/frm" << std::setw(10) << "tex/frm"
+              << std::setw(11) << "KB up/frm" << std::setw(11) << "draws/frm" << std::setw(8) << "hits" << "\n";
+}
+
+void PrintTableRow(const std::string& label,
+                   const std::string& phase,
+                   const RollingHistogram& ms,
+                   const PerfCounters::Snapshot& totals,
+                   size_t frames,
+                   size_t cache_hits) {
+    double n = frames > 0 ? static_cast<double>(frames) : 1.0;
+    std::cout << std::left << std::setw(22) << label << std::setw(8) << phase << std::right
+              << std::setw(7) << frames << std::fixed << std::setprecision(2)
+              << std::setw(9) << ms.Percentile(0.50) << std::setw(9) << ms.Percentile(0.95)
+              << std::setw(9) << ms.Max() << std::setprecision(1)
+              << std::setw(10) << (totals.sql_queries / n) << std::setw(10) << (totals.textures_created / n)
+              << std::setw(11) << (totals.texture_bytes / 1024.0 / n) << std::setw(11) << (totals.draw_calls / n)
+              << std::setw(8) << cache_hits << "\n";
+}
+
+} // namespace Bench
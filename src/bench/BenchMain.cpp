@@ -0,0 +1,56 @@
+#include "bench/Bench.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void PrintUsage() {
+    std::cerr << "Usage: rpi_calendar_bench <command> [options]\n"
+              << "\n"
+              << "Commands:\n"
+              << "  render   Render every view headlessly and report frame time distributions\n"
+              << "           --size WxH (repeatable, default 800x480 1920x1080 3840x2160)\n"
+              << "           --frames N (default 200)  --view all|clock|calendar|weather\n"
+              << "           --font PATH  --sprites DIR  --weather-sprites DIR\n"
+              << "  text     Compare the old byte-wise TruncateText with TextMeasure\n"
+              << "           --width PX (repeatable, default 120 240 480)  --iterations N (default 200)\n"
+              << "           --font PATH  --font-size PT (default 16)\n"
+              << "  steady   Fail unless unchanged frames allocate nothing and create no textures\n"
+              << "           --size WxH (repeatable, default 800x480)  --frames N (default 300)\n"
+              << "           --view all|clock|calendar|weather  --font PATH  --sprites DIR  --weather-sprites DIR\n"
+              << "  db       Time each EventStore call against preparing its SQL on every call, the views'\n"
+              << "           event queries against the in-memory snapshot, and whole syncs applied per\n"
+              << "           event in autocommit against one ApplySync transaction\n"
+              << "           --events N (default 500)  --iterations N (default 2000)\n"
+              << "           --feed N (repeatable, default 100 1000 5000)\n"
+              << "           --history N (repeatable, default 1000 10000 100000)  --db PATH (default a temp file)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        PrintUsage();
+        return 2;
+    }
+
+    std::string command = argv[1];
+    std::vector<std::string> args(argv + 2, argv + argc);
+    if (command == "render") {
+        return Bench::RunRenderBench(args);
+    }
+    if (command == "text") {
+        return Bench::RunTextBench(args);
+    }
+    if (command == "steady") {
+        return Bench::RunSteadyBench(args);
+    }
+    if (command == "db") {
+        return Bench::RunDbBench(args);
+    }
+
+    PrintUsage();
+    return 2;
+}
@@ -0,0 +1,206 @@
+#include "bench/Bench.h"
+
+#include "db/EventSnapshot.h"
+#include "db/EventStore.h"
+#include "render/Compositor.h"
+#include "render/FontRegistry.h"
+#include "render/FrameProfiler.h"
+#include "render/TextCache.h"
+#include "render/TextRenderer.h"
+#include "util/TimeUtil.h"
+
+#include <SDL_ttf.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+namespace {
+
+struct RenderOptions {
+    std::string font_path = "./assets/Minecraft.ttf";
+    std::string sprite_dir = "./assets/sprites";
+    std::string weather_sprite_dir = "./assets/weather";
+    std::string view = "all";
+    int frames = 200;
+    std::vector<Resolution> sizes;
+};
+
+bool ParseOptions(const std::vector<std::string>& args, RenderOptions* out) {
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool has_value = i + 1 < args.size();
+        if (arg == "--font" && has_value) {
+            out->font_path = args[++i];
+        } else if (arg == "--sprites" && has_value) {
+            out->sprite_dir = args[++i];
+        } else if (arg == "--weather-sprites" && has_value) {
+            out->weather_sprite_dir = args[++i];
+        } else if (arg == "--view" && has_value) {
+            out->view = args[++i];
+            if (out->view != "all" && out->view != "clock" && out->view != "calendar" && out->view != "weather") {
+                std::cerr << "Unknown view: " << out->view << "\n";
+                return false;
+            }
+        } else if (arg == "--frames" && has_value) {
+            out->frames = std::atoi(args[++i].c_str());
+            if (out->frames < 1 || out->frames > 100000) {
+                std::cerr << "--frames must be between 1 and 100000.\n";
+                return false;
+            }
+        } else if (arg == "--size" && has_value) {
+            Resolution size;
+            if (!ParseResolution(args[++i], &size)) {
+                std::cerr << "Malformed --size, expected WxH: " << args[i] << "\n";
+                return false;
+            }
+            out->sizes.push_back(size);
+        } else {
+            std::cerr << "Unknown render bench option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (out->sizes.empty()) {
+        out->sizes = { { 800, 480 }, { 1920, 1080 }, { 3840, 2160 } };
+    }
+    return true;
+}
+
+struct PhaseStats {
+    explicit PhaseStats(size_t frames) : ms(frames) {}
+
+    RollingHistogram ms;
+    PerfCounters::Snapshot totals;
+    size_t frames = 0;
+    size_t cache_hits = 0;
+};
+
+// One frame exactly as the main loop draws it: view cache update, layer
+// compositing and present.
+void RunFrame(SDL_Renderer* renderer, Compositor* compositor, LayeredView* view,
+              const Bench::Resolution& size, int64_t now_ts, PhaseStats* stats) {
+    PerfCounters::Snapshot before = PerfCounters::Read();
+    auto start = std::chrono::steady_clock::now();
+
+    LayerChanges changes = view->Prepare(size.width, size.height, now_ts);
+    compositor->Draw(view, changes, size.width, size.height);
+    SDL_RenderPresent(renderer);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    PerfCounters::Snapshot delta = PerfCounters::Delta(before, PerfCounters::Read());
+    stats->ms.Add(ms);
+    stats->totals.sql_queries += delta.sql_queries;
+    stats->totals.textures_created += delta.textures_created;
+    stats->totals.texture_bytes += delta.texture_bytes;
+    stats->totals.draw_calls += delta.draw_calls;
+    stats->frames += 1;
+    if (!changes.static_layer && !changes.dynamic_layer) {
+        stats->cache_hits += 1;
+    }
+}
+
+// first:  a freshly constructed view, as on the first SPACE press.
+// warm:   the first frame of a second instance that was prewarmed the way
+//         the main loop does it while idle.
+// steady: repeated frames with no data or clock change.
+// minute: every frame crosses a minute boundary, forcing a dynamic redraw.
+void BenchView(const std::string& label, SDL_Renderer* renderer,
+               const std::function<std::unique_ptr<LayeredView>()>& make_view,
+               const Bench::Resolution& size, int64_t now_ts, int frames) {
+    Compositor compositor(renderer);
+    std::unique_ptr<LayeredView> view_owner = make_view();
+    LayeredView* view = view_owner.get();
+
+    PhaseStats first(1);
+    RunFrame(renderer, &compositor, view, size, now_ts, &first);
+
+    PhaseStats warm(1);
+    {
+        Compositor warm_compositor(renderer);
+        std::unique_ptr<LayeredView> warm_view = make_view();
+        warm_compositor.Prewarm(warm_view.get(), warm_view->Prepare(size.width, size.height, now_ts),
+                                size.width, size.height);
+        RunFrame(renderer, &warm_compositor, warm_view.get(), size, now_ts, &warm);
+    }
+
+    PhaseStats steady(static_cast<size_t>(frames));
+    for (int i = 0; i < frames; ++i) {
+        RunFrame(renderer, &compositor, view, size, now_ts, &steady);
+    }
+
+    PhaseStats minute(static_cast<size_t>(frames));
+    for (int i = 1; i <= frames; ++i) {
+        RunFrame(renderer, &compositor, view, size, now_ts + static_cast<int64_t>(i) * 60, &minute);
+    }
+
+    PrintTableRow(label, "first", first.ms, first.totals, first.frames, first.cache_hits);
+    PrintTableRow(label, "warm", warm.ms, warm.totals, warm.frames, warm.cache_hits);
+    PrintTableRow(label, "steady", steady.ms, steady.totals, steady.frames, steady.cache_hits);
+    PrintTableRow(label, "minute", minute.ms, minute.totals, minute.frames, minute.cache_hits);
+}
+
+} // namespace
+
+int RunRenderBench(const std::vector<std::string>& args) {
+    RenderOptions options;
+    if (!ParseOptions(args, &options)) {
+        return 2;
+    }
+    if (!InitHeadlessSdl()) {
+        return 1;
+    }
+
+    int result = 0;
+    {
+        EventStore store(":memory:");
+        BenchSnapshots snapshots;
+        FontRegistry font_registry;
+        BenchFonts fonts = RegisterFonts(&font_registry, options.font_path);
+        int64_t now_ts = TimeUtil::NowTs();
+        if (!store.Open() || !SeedStore(&store, &snapshots, now_ts) || !fonts.time.Get()) {
+            result = 1;
+        } else {
+            PrintTableHeader();
+            for (const Resolution& size : options.sizes) {
+                HeadlessTarget target;
+                if (!CreateHeadlessTarget(size, &target)) {
+                    result = 1;
+                    break;
+                }
+                std::string suffix = " " + std::to_string(size.width) + "x" + std::to_string(size.height);
+                SDL_Renderer* renderer = target.renderer;
+                TextRenderer text_renderer(renderer);
+                for (const char* name : { "clock", "calendar", "weather" }) {
+                    if (options.view != "all" && options.view != name) {
+                        continue;
+                    }
+                    BenchView(name + suffix, renderer, [&]() {
+                        return MakeView(name, renderer, &text_renderer, fonts, snapshots, options.sprite_dir,
+                                        options.weather_sprite_dir);
+                    }, size, now_ts, options.frames);
+                }
+                for (const std::string& line : text_renderer.Cache().Report()) {
+                    std::cout << line << suffix << "\n";
+                }
+                // The atlas belongs to this renderer; drop it before the renderer goes.
+                text_renderer.Reset();
+                DestroyHeadlessTarget(&target);
+            }
+            for (const std::string& line : font_registry.MemoryReport()) {
+                std::cout << line << "\n";
+            }
+        }
+        font_registry.CloseAll();
+    }
+
+    ShutdownHeadlessSdl();
+    return result;
+}
+
+} // namespace Bench
@@ -0,0 +1,193 @@
+#include "bench/Bench.h"
+
+#include "db/EventSnapshot.h"
+#include "db/EventStore.h"
+#include "render/Compositor.h"
+#include "render/FontRegistry.h"
+#include "render/LayeredView.h"
+#include "render/TextRenderer.h"
+#include "util/TimeUtil.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+namespace {
+
+// Frames rendered before counting, so view caches are built and scratch
+// vectors have reached their steady capacity.
+constexpr int kWarmupFrames = 3;
+
+struct SteadyOptions {
+    std::string font_path = "./assets/Minecraft.ttf";
+    std::string sprite_dir = "./assets/sprites";
+    std::string weather_sprite_dir = "./assets/weather";
+    std::string view = "all";
+    int frames = 300;
+    std::vector<Resolution> sizes;
+};
+
+bool ParseOptions(const std::vector<std::string>& args, SteadyOptions* out) {
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool has_value = i + 1 < args.size();
+        if (arg == "--font" && has_value) {
+            out->font_path = args[++i];
+        } else if (arg == "--sprites" && has_value) {
+            out->sprite_dir = args[++i];
+        } else if (arg == "--weather-sprites" && has_value) {
+            out->weather_sprite_dir = args[++i];
+        } else if (arg == "--view" && has_value) {
+            out->view = args[++i];
+            if (out->view != "all" && out->view != "clock" && out->view != "calendar" && out->view != "weather") {
+                std::cerr << "Unknown view: " << out->view << "\n";
+                return false;
+            }
+        } else if (arg == "--frames" && has_value) {
+            out->frames = std::atoi(args[++i].c_str());
+            if (out->frames < 1 || out->frames > 100000) {
+                std::cerr << "--frames must be between 1 and 100000.\n";
+                return false;
+            }
+        } else if (arg == "--size" && has_value) {
+            Resolution size;
+            if (!ParseResolution(args[++i], &size)) {
+                std::cerr << "Malformed --size, expected WxH: " << args[i] << "\n";
+                return false;
+            }
+            out->sizes.push_back(size);
+        } else {
+            std::cerr << "Unknown steady bench option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (out->sizes.empty()) {
+        out->sizes = { { 800, 480 } };
+    }
+    return true;
+}
+
+// Allocations and texture creations over a run of frames.
+struct SteadyCounts {
+    uint64_t allocations = 0;
+    uint64_t textures = 0;
+};
+
+// "layered": the main loop's path, Prepare then a Compositor copy.
+// "direct": Prepare and both Render passes every frame, which is what the
+// Compositor falls back to when the renderer has no render targets.
+void RenderFrame(SDL_Renderer* renderer, Compositor* compositor, LayeredView* view, const Resolution& size,
+                 int64_t now_ts, bool direct) {
+    LayerChanges changes = view->Prepare(size.width, size.height, now_ts);
+    if (direct) {
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderClear(renderer);
+        view->RenderStatic(size.width, size.height);
+        view->RenderDynamic(size.width, size.height);
+    } else {
+        compositor->Draw(view, changes, size.width, size.height);
+    }
+    SDL_RenderPresent(renderer);
+}
+
+SteadyCounts CountFrames(SDL_Renderer* renderer, Compositor* compositor, LayeredView* view, const Resolution& size,
+                         int64_t now_ts, int frames, bool direct) {
+    for (int i = 0; i < kWarmupFrames; ++i) {
+        RenderFrame(renderer, compositor, view, size, now_ts, direct);
+    }
+    uint64_t allocations_before = AllocationCount();
+    PerfCounters::Snapshot before = PerfCounters::Read();
+    for (int i = 0; i < frames; ++i) {
+        RenderFrame(renderer, compositor, view, size, now_ts, direct);
+    }
+    SteadyCounts counts;
+    counts.allocations = AllocationCount() - allocations_before;
+    counts.textures = PerfCounters::Delta(before, PerfCounters::Read()).textures_created;
+    return counts;
+}
+
+bool PrintRow(const std::string& label, const char* mode, int frames, const SteadyCounts& counts) {
+    bool ok = counts.allocations == 0 && counts.textures == 0;
+    std::cout << std::left << std::setw(22) << label << std::setw(9) << mode << std::right << std::setw(7) << frames
+              << std::setw(9) << counts.allocations << std::setw(10) << counts.textures << "  "
+              << (ok ? "ok" : "FAIL") << "\n";
+    return ok;
+}
+
+} // namespace
+
+int RunSteadyBench(const std::vector<std::string>& args) {
+    SteadyOptions options;
+    if (!ParseOptions(args, &options)) {
+        return 2;
+    }
+    // Has to happen before SDL allocates anything.
+    if (!InstallSdlAllocationCounter()) {
+        std::cerr << "SDL allocation counting unavailable; counting C++ allocations only.\n";
+    }
+    if (!InitHeadlessSdl()) {
+        return 1;
+    }
+
+    int result = 0;
+    bool allocated = false;
+    {
+        EventStore store(":memory:");
+        BenchSnapshots snapshots;
+        FontRegistry font_registry;
+        BenchFonts fonts = RegisterFonts(&font_registry, options.font_path);
+        int64_t now_ts = TimeUtil::NowTs();
+        if (!store.Open() || !SeedStore(&store, &snapshots, now_ts) || !fonts.time.Get()) {
+            result = 1;
+        } else {
+            std::cout << std::left << std::setw(22) << "case" << std::setw(9) << "mode" << std::right
+                      << std::setw(7) << "frames" << std::setw(9) << "allocs" << std::setw(10) << "textures"
+                      << "\n";
+            for (const Resolution& size : options.sizes) {
+                HeadlessTarget target;
+                if (!CreateHeadlessTarget(size, &target)) {
+                    result = 1;
+                    break;
+                }
+                std::string suffix = " " + std::to_string(size.width) + "x" + std::to_string(size.height);
+                SDL_Renderer* renderer = target.renderer;
+                {
+                    TextRenderer text_renderer(renderer);
+                    for (const char* name : { "clock", "calendar", "weather" }) {
+                        if (options.view != "all" && options.view != name) {
+                            continue;
+                        }
+                        Compositor compositor(renderer);
+                        std::unique_ptr<LayeredView> view = MakeView(name, renderer, &text_renderer, fonts, snapshots,
+                                                                     options.sprite_dir, options.weather_sprite_dir);
+                        SteadyCounts layered = CountFrames(renderer, &compositor, view.get(), size, now_ts,
+                                                           options.frames, false);
+                        SteadyCounts direct = CountFrames(renderer, &compositor, view.get(), size, now_ts,
+                                                          options.frames, true);
+                        bool layered_ok = PrintRow(name + suffix, "layered", options.frames, layered);
+                        bool direct_ok = PrintRow(name + suffix, "direct", options.frames, direct);
+                        if (!layered_ok || !direct_ok) {
+                            allocated = true;
+                        }
+                    }
+                }
+                DestroyHeadlessTarget(&target);
+            }
+        }
+        font_registry.CloseAll();
+    }
+
+    ShutdownHeadlessSdl();
+    if (allocated) {
+        std::cerr << "Steady-state frames allocated memory or created textures.\n";
+        result = 1;
+    }
+    return result;
+}
+
+} // namespace Bench
@@ -0,0 +1,197 @@
+#include "bench/Bench.h"
+
+#include "render/FontRegistry.h"
+#include "render/TextMeasure.h"
+#include "util/Utf8.h"
+
+#include <SDL_ttf.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+namespace {
+
+struct TextOptions {
+    std::string font_path = "./assets/Minecraft.ttf";
+    int font_size = 16;
+    int iterations = 200;
+    std::vector<int> widths;
+};
+
+// Agenda and footer lines of the kind the views truncate, including
+// multibyte titles that a byte-wise cut can split.
+const char* const kCorpus[] = {
+    "Next: 9:30 AM - Team standup (in 25m)",
+    "10:00 AM  Quarterly planning review with product, design and engineering leads",
+    "All day  Company offsite - travel day, see the shared itinerary for details",
+    "2:15 PM  Dentist",
+    "Next: 4:00 PM - Caf\xC3\xA9 m\xC3\xBCnchen \xE2\x80\x93 \xC3\x9C" "bergabe der Schl\xC3\xBCssel an die Hausverwaltung (in 3h 5m)",
+    "6:30 PM  \xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE4\xBC\x9A\xE8\xAD\xB0\xE3\x81\xA8\xE5\xA4\x95\xE9\xA3\x9F\xE4\xBC\x9A\xE3\x81\xAE\xE6\xBA\x96\xE5\x82\x99",
+    "12 C Partly cloudy with a chance of afternoon showers (cached)",
+    "H 18 C / L 9 C",
+    "Synced 3m ago",
+};
+
+// The per-view helper this module replaced: one TTF_SizeUTF8 per byte
+// dropped, on a fresh substring each time.
+std::string LegacyTruncate(TTF_Font* font, const std::string& text, int max_width) {
+    int w = 0;
+    int h = 0;
+    if (TTF_SizeUTF8(font, text.c_str(), &w, &h) == 0 && w <= max_width) {
+        return text;
+    }
+    const std::string ellipsis = "...";
+    for (size_t len = text.size(); len > 0; --len) {
+        std::string candidate = text.substr(0, len) + ellipsis;
+        if (TTF_SizeUTF8(font, candidate.c_str(), &w, &h) == 0 && w <= max_width) {
+            return candidate;
+        }
+    }
+    return ellipsis;
+}
+
+bool IsValidUtf8(const std::string& text) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        if (Utf8::DecodeNext(text, &pos) == Utf8::kReplacementChar) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ParseOptions(const std::vector<std::string>& args, TextOptions* out) {
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool has_value = i + 1 < args.size();
+        if (arg == "--font" && has_value) {
+            out->font_path = args[++i];
+        } else if (arg == "--font-size" && has_value) {
+            out->font_size = std::atoi(args[++i].c_str());
+            if (out->font_size < 4 || out->font_size > 400) {
+                std::cerr << "--font-size must be between 4 and 400.\n";
+                return false;
+            }
+        } else if (arg == "--iterations" && has_value) {
+            out->iterations = std::atoi(args[++i].c_str());
+            if (out->iterations < 1 || out->iterations > 1000000) {
+                std::cerr << "--iterations must be between 1 and 1000000.\n";
+                return false;
+            }
+        } else if (arg == "--width" && has_value) {
+            int width = std::atoi(args[++i].c_str());
+            if (width < 1 || width > 100000) {
+                std::cerr << "--width must be between 1 and 100000.\n";
+                return false;
+            }
+            out->widths.push_back(width);
+        } else {
+            std::cerr << "Unknown text bench option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (out->widths.empty()) {
+        out->widths = { 120, 240, 480 };
+    }
+    return true;
+}
+
+struct TruncateRun {
+    double ns_per_call = 0.0;
+    size_t calls = 0;
+    size_t invalid_utf8 = 0;
+};
+
+// Truncates every corpus line at every width, `iterations` times over.
+// `begin_pass` runs untimed before each pass.
+TruncateRun RunTruncate(const TextOptions& options,
+                        const std::function<std::string(const std::string&, int)>& truncate,
+                        const std::function<void()>& begin_pass) {
+    TruncateRun run;
+    std::chrono::steady_clock::duration total{};
+    for (int pass = 0; pass < options.iterations; ++pass) {
+        if (begin_pass) {
+            begin_pass();
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (const char* line : kCorpus) {
+            for (int width : options.widths) {
+                std::string result = truncate(line, width);
+                if (pass == 0 && !IsValidUtf8(result)) {
+                    ++run.invalid_utf8;
+                }
+                ++run.calls;
+            }
+        }
+        total += std::chrono::steady_clock::now() - start;
+    }
+    double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(total).count());
+    run.ns_per_call = run.calls > 0 ? ns / static_cast<double>(run.calls) : 0.0;
+    return run;
+}
+
+void PrintRun(const std::string& label, const TruncateRun& run, double baseline_ns) {
+    std::cout << std::left << std::setw(16) << label << std::right << std::setw(10) << run.calls
+              << std::fixed << std::setprecision(0) << std::setw(12) << run.ns_per_call
+              << std::setprecision(1) << std::setw(10)
+              << (run.ns_per_call > 0.0 ? baseline_ns / run.ns_per_call : 0.0)
+              << std::setw(14) << run.invalid_utf8 << "\n";
+}
+
+} // namespace
+
+int RunTextBench(const std::vector<std::string>& args) {
+    TextOptions options;
+    if (!ParseOptions(args, &options)) {
+        return 2;
+    }
+    if (!InitHeadlessSdl()) {
+        return 1;
+    }
+
+    int result = 0;
+    {
+        FontRegistry font_registry;
+        TTF_Font* font = font_registry.Register(options.font_path, options.font_size).Get();
+        if (!font) {
+            result = 1;
+        } else {
+            TruncateRun legacy = RunTruncate(options, [&](const std::string& text, int width) {
+                return LegacyTruncate(font, text, width);
+            }, nullptr);
+
+            // cold: a fresh TextMeasure per pass, so advances are looked up
+            // and every result is computed. memo: one TextMeasure throughout.
+            std::unique_ptr<TextMeasure> cold;
+            TruncateRun cold_run = RunTruncate(options, [&](const std::string& text, int width) {
+                return cold->Truncate(font, text, width);
+            }, [&]() { cold = std::make_unique<TextMeasure>(); });
+
+            TextMeasure memo;
+            TruncateRun memo_run = RunTruncate(options, [&](const std::string& text, int width) {
+                return memo.Truncate(font, text, width);
+            }, nullptr);
+
+            std::cout << std::left << std::setw(16) << "truncate" << std::right << std::setw(10) << "calls"
+                      << std::setw(12) << "ns/call" << std::setw(10) << "speedup" << std::setw(14) << "broken utf8"
+                      << "\n";
+            PrintRun("legacy", legacy, legacy.ns_per_call);
+            PrintRun("measure cold", cold_run, legacy.ns_per_call);
+            PrintRun("measure memo", memo_run, legacy.ns_per_call);
+        }
+        font_registry.CloseAll();
+    }
+
+    ShutdownHeadlessSdl();
+    return result;
+}
+
+} // namespace Bench
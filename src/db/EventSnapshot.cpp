@@ -0,0 +1,130 @@
+#include "db/EventSnapshot.h"
+
+#include "util/TimeUtil.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+bool StartsBefore(const EventRecord& ev, int64_t ts) {
+    return ev.start_ts < ts;
+}
+
+} // namespace
+
+EventSnapshot::EventSnapshot(std::vector<EventRecord> events, std::vector<DayCount> days)
+    : events_(std::move(events)), days_(std::move(days)) {
+    // ReadSnapshot already filters and orders; this keeps the invariant for
+    // any other caller.
+    events_.erase(std::remove_if(events_.begin(), events_.end(),
+                                 [](const EventRecord& ev) { return ev.status == "cancelled"; }),
+                  events_.end());
+    std::stable_sort(events_.begin(), events_.end(), [](const EventRecord& a, const EventRecord& b) {
+        return a.start_ts < b.start_ts || (a.start_ts == b.start_ts && a.id < b.id);
+    });
+    std::sort(days_.begin(), days_.end(), [](const DayCount& a, const DayCount& b) { return a.date < b.date; });
+    BuildLatestEnd();
+}
+
+std::shared_ptr<const EventSnapshot> EventSnapshot::Load(EventStore* store) {
+    std::vector<EventRecord> events;
+    std::vector<DayCount> days;
+    if (!store->ReadSnapshot(&events, &days)) {
+        return nullptr;
+    }
+    return std::make_shared<const EventSnapshot>(std::move(events), std::move(days));
+}
+
+void EventSnapshot::BuildLatestEnd() {
+    size_t count = events_.size();
+    floor_log2_.assign(count + 1, 0);
+    for (size_t len = 2; len <= count; ++len) {
+        floor_log2_[len] = static_cast<uint8_t>(floor_log2_[len / 2] + 1);
+    }
+    latest_end_.clear();
+    if (count == 0) {
+        return;
+    }
+    std::vector<uint32_t> single(count);
+    for (size_t i = 0; i < count; ++i) {
+        single[i] = static_cast<uint32_t>(i);
+    }
+    latest_end_.push_back(std::move(single));
+    for (size_t width = 2; width <= count; width *= 2) {
+        std::vector<uint32_t> level(count - width + 1);
+        const std::vector<uint32_t>& halves = latest_end_.back();
+        for (size_t i = 0; i < level.size(); ++i) {
+            level[i] = LaterEnd(halves[i], halves[i + width / 2]);
+        }
+        latest_end_.push_back(std::move(level));
+    }
+}
+
+uint32_t EventSnapshot::LaterEnd(uint32_t a, uint32_t b) const {
+    return events_[a].end_ts >= events_[b].end_ts ? a : b;
+}
+
+uint32_t EventSnapshot::LatestEndIn(size_t first, size_t last) const {
+    // Two table entries that together cover the range exactly.
+    size_t level = floor_log2_[last - first];
+    size_t width = size_t{1} << level;
+    return LaterEnd(latest_end_[level][first], latest_end_[level][last - width]);
+}
+
+bool EventSnapshot::NextEventAfter(int64_t ts, EventRecord* out) const {
+    auto it = std::lower_bound(events_.begin(), events_.end(), ts, StartsBefore);
+    if (it == events_.end()) {
+        return false;
+    }
+    *out = *it;
+    return true;
+}
+
+std::vector<EventRecord> EventSnapshot::EventsForDay(int64_t day_ts) const {
+    return EventsOverlapping(TimeUtil::StartOfDay(day_ts), TimeUtil::EndOfDay(day_ts));
+}
+
+std::vector<EventRecord> EventSnapshot::EventsOverlapping(int64_t start, int64_t end) const {
+    std::vector<EventRecord> out;
+    auto stop = std::upper_bound(events_.begin(), events_.end(), end,
+                                 [](int64_t ts, const EventRecord& ev) { return ts < ev.start_ts; });
+    // Ranges still to split, left part on top so matches come out in start
+    // order; a range with first == last stands for the match events_[first].
+    std::vector<std::pair<size_t, size_t>> pending;
+    if (stop != events_.begin()) {
+        pending.emplace_back(0, static_cast<size_t>(stop - events_.begin()));
+    }
+    while (!pending.empty()) {
+        auto [first, last] = pending.back();
+        pending.pop_back();
+        if (first == last) {
+            out.push_back(events_[first]);
+            continue;
+        }
+        size_t latest = LatestEndIn(first, last);
+        if (events_[latest].end_ts < start) {
+            continue;
+        }
+        if (latest + 1 < last) {
+            pending.emplace_back(latest + 1, last);
+        }
+        pending.emplace_back(latest, latest);
+        if (first < latest) {
+            pending.emplace_back(first, latest);
+        }
+    }
+    return out;
+}
+
+std::map<int, int> EventSnapshot::EventDaysInMonth(int year, int month) const {
+    std::map<int, int> counts;
+    int first = year * 10000 + month * 100 + 1;
+    auto it = std::lower_bound(days_.begin(), days_.end(), first,
+                               [](const DayCount& day, int date) { return day.date < date; });
+    for (; it != days_.end() && it->date <= first + 30; ++it) {
+        counts[it->date % 100] = it->count;
+    }
+    return counts;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "db/EventStore.h"
+#include "db/SnapshotSlot.h"
+
+// Immutable copy of every event that is not cancelled, sorted by start time,
+// answering the same queries as EventStore without touching SQLite. Built on
+// the calendar sync thread after a sync and then only ever read, so any
+// number of threads may query one concurrently.
+//
+// The events an overlap query can match are the prefix starting by the
+// query's end; the matches are those in it ending at or after the query's
+// start. A sparse table names the latest-ending event of any range in
+// constant time, so a lookup takes the prefix's latest-ending event, stops
+// if that ends too early, and otherwise reports it and repeats on both
+// sides of it. Every step reports a match or closes a range, so a lookup
+// costs one binary search plus O(k) for k matches: O(log n + k) whatever
+// mix of past, long and zero-length events the snapshot holds. The table
+// is O(n log n) indices, built once per sync.
+class EventSnapshot {
+public:
+    EventSnapshot() = default;
+    // `events` and `days` as EventStore::ReadSnapshot returns them.
+    EventSnapshot(std::vector<EventRecord> events, std::vector<DayCount> days);
+
+    // Reads the store's current events; nullptr if that fails, so a failed
+    // read is never mistaken for an empty calendar.
+    static std::shared_ptr<const EventSnapshot> Load(EventStore* store);
+
+    bool NextEventAfter(int64_t ts, EventRecord* out) const;
+    std::vector<EventRecord> EventsForDay(int64_t day_ts) const;
+    // Events with start_ts <= end and end_ts >= start, by start time.
+    std::vector<EventRecord> EventsOverlapping(int64_t start, int64_t end) const;
+    std::map<int, int> EventDaysInMonth(int year, int month) const;
+
+    size_t Size() const { return events_.size(); }
+
+private:
+    void BuildLatestEnd();
+    uint32_t LaterEnd(uint32_t a, uint32_t b) const;
+    // Index of the latest-ending event in events_[first, last); last > first.
+    uint32_t LatestEndIn(size_t first, size_t last) const;
+
+    std::vector<EventRecord> events_;
+    // By date; the month grid reads at most 31 of them.
+    std::vector<DayCount> days_;
+    // latest_end_[j][i]: index of the latest-ending event in
+    // events_[i, i + 2^j).
+    std::vector<std::vector<uint32_t>> latest_end_;
+    // floor_log2_[len]: the latest_end_ level covering a range of len.
+    std::vector<uint8_t> floor_log2_;
+};
+
+// The slot the calendar sync thread publishes events through.
+class EventSnapshotSlot : public SnapshotSlot<EventSnapshot> {};
@@ -1,14 +1,25 @@
 #include "db/EventStore.h"
 
+#include "util/PerfCounters.h"
 #include "util/TimeUtil.h"
 
 #include <sqlite3.h>
 #include <cctype>
+#include <ctime>
 #include <iostream>
-#include <memory>
+#include <map>
+#include <utility>
 
 namespace {
 
+// PRAGMA user_version this code writes. 1: event_days holds the per-date
+// counts.
+constexpr int kSchemaVersion = 1;
+
+// An event spanning more than a year still marks only its first year of
+// dates, so one malformed end time cannot write thousands of buckets.
+constexpr int kMaxEventDays = 366;
+
 bool ContainsUnsafeText(const std::string& value) {
     for (char c : value) {
         unsigned char uc = static_cast<unsigned char>(c);
@@ -44,23 +55,96 @@ bool IsValidMetaEntry(const std::string& key, const std::string& value) {
     return IsSafeField(key, 64, false) && IsSafeField(value, 256, true);
 }
 
-struct StmtDeleter {
-    void operator()(sqlite3_stmt* stmt) const {
-        if (stmt) {
-            sqlite3_finalize(stmt);
-        }
-    }
+// Indexed by EventStore::Stmt.
+const char* const kStatementSql[] = {
+    // UpsertEvent
+    "INSERT INTO events(id, calendar_id, title, start_ts, end_ts, all_day, location, updated_ts, status)"
+    " VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?)"
+    " ON CONFLICT(id) DO UPDATE SET"
+    " calendar_id=excluded.calendar_id,"
+    " title=excluded.title,"
+    " start_ts=excluded.start_ts,"
+    " end_ts=excluded.end_ts,"
+    " all_day=excluded.all_day,"
+    " location=excluded.location,"
+    " updated_ts=excluded.updated_ts,"
+    " status=excluded.status",
+    // NextEventAfter
+    "SELECT id, calendar_id, title, start_ts, end_ts, all_day, location, updated_ts, status"
+    " FROM events WHERE start_ts >= ? AND status != 'cancelled'"
+    " ORDER BY start_ts ASC LIMIT 1",
+    // EventDaysInMonth
+    "SELECT day, count FROM event_days WHERE day BETWEEN ? AND ? AND count > 0",
+    // AllEvents
+    "SELECT id, calendar_id, title, start_ts, end_ts, all_day, location, updated_ts, status"
+    " FROM events WHERE status != 'cancelled'"
+    " ORDER BY start_ts ASC, id ASC",
+    // AllEventDays
+    "SELECT day, count FROM event_days WHERE count > 0 ORDER BY day ASC",
+    // EventSpan: what the row marked in event_days before it is rewritten.
+    "SELECT start_ts, end_ts, status FROM events WHERE id = ?",
+    // StaleSpans: the rows DeleteStale is about to remove.
+    "SELECT start_ts, end_ts, status FROM events WHERE calendar_id = ?"
+    " AND start_ts <= ? AND end_ts >= ?"
+    " AND updated_ts < ?",
+    // AddDayCount
+    "INSERT INTO event_days(day, count) VALUES(?, ?)"
+    " ON CONFLICT(day) DO UPDATE SET count = count + excluded.count",
+    // DeleteStale
+    "DELETE FROM events WHERE calendar_id = ?"
+    " AND start_ts <= ? AND end_ts >= ?"
+    " AND updated_ts < ?",
+    // SetMeta
+    "INSERT INTO meta(key, value) VALUES(?, ?)"
+    " ON CONFLICT(key) DO UPDATE SET value=excluded.value",
+    // GetMeta
+    "SELECT value FROM meta WHERE key = ?",
+    // Begin: take the write lock up front rather than upgrading mid-sync.
+    "BEGIN IMMEDIATE",
+    // BeginRead: one consistent view across several reads.
+    "BEGIN",
+    // Commit
+    "COMMIT",
+    // Rollback
+    "ROLLBACK",
 };
 
-using StmtPtr = std::unique_ptr<sqlite3_stmt, StmtDeleter>;
+int DateKey(const std::tm& tm) {
+    return (tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday;
+}
 
-StmtPtr Prepare(sqlite3* db, const std::string& sql) {
+// Local dates (yyyymmdd) an event marks in the month grid: the day it starts
+// through the day of its last second, so one ending at midnight leaves the
+// next day unmarked. Steps through the dates at local noon rather than
+// adding 86400, which would skip or repeat a date across a DST change.
+std::vector<int> EventDates(int64_t start_ts, int64_t end_ts) {
+    std::vector<int> dates;
+    std::tm day = TimeUtil::LocalTime(start_ts);
+    int last = DateKey(TimeUtil::LocalTime(end_ts > start_ts ? end_ts - 1 : start_ts));
+    for (int date = DateKey(day); date <= last && dates.size() < kMaxEventDays; date = DateKey(day)) {
+        dates.push_back(date);
+        day.tm_mday += 1;
+        day.tm_hour = 12;
+        day.tm_min = 0;
+        day.tm_sec = 0;
+        day.tm_isdst = -1;
+        std::mktime(&day);
+    }
+    return dates;
+}
+
+bool ReadUserVersion(sqlite3* db, int* out) {
     sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version", -1, &stmt, nullptr) != SQLITE_OK) {
         std::cerr << "SQLite prepare failed: " << sqlite3_errmsg(db) << "\n";
-        return nullptr;
+        return false;
     }
-    return StmtPtr(stmt);
+    bool ok = sqlite3_step(stmt) == SQLITE_ROW;
+    if (ok) {
+        *out = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return ok;
 }
 
 std::string ColumnText(sqlite3_stmt* stmt, int col) {
@@ -68,8 +152,49 @@ std::string ColumnText(sqlite3_stmt* stmt, int col) {
     return text ? reinterpret_cast<const char*>(text) : "";
 }
 
+// Reads a row selected as id, calendar_id, title, start_ts, end_ts, all_day,
+// location, updated_ts, status.
+void ReadEventRow(sqlite3_stmt* stmt, EventRecord* out) {
+    out->id = ColumnText(stmt, 0);
+    out->calendar_id = ColumnText(stmt, 1);
+    out->title = ColumnText(stmt, 2);
+    out->start_ts = sqlite3_column_int64(stmt, 3);
+    out->end_ts = sqlite3_column_int64(stmt, 4);
+    out->all_day = sqlite3_column_int(stmt, 5) != 0;
+    out->location = ColumnText(stmt, 6);
+    out->updated_ts = sqlite3_column_int64(stmt, 7);
+    out->status = ColumnText(stmt, 8);
+}
+
 } // namespace
 
+// Borrows a cached statement for one call. Resets it and clears its
+// bindings on scope exit, so a SELECT stopped after its first row does not
+// keep its read transaction open.
+class EventStore::StmtUse {
+public:
+    StmtUse(EventStore* store, Stmt which) : stmt_(store->stmts_[static_cast<size_t>(which)]) {
+        if (stmt_) {
+            PerfCounters::AddSqlQuery();
+        }
+    }
+    ~StmtUse() {
+        if (stmt_) {
+            sqlite3_reset(stmt_);
+            sqlite3_clear_bindings(stmt_);
+        }
+    }
+
+    StmtUse(const StmtUse&) = delete;
+    StmtUse& operator=(const StmtUse&) = delete;
+
+    sqlite3_stmt* get() const { return stmt_; }
+    explicit operator bool() const { return stmt_ != nullptr; }
+
+private:
+    sqlite3_stmt* stmt_;
+};
+
 EventStore::EventStore(const std::string& db_path) : db_path_(db_path) {}
 
 EventStore::~EventStore() {
@@ -84,10 +209,11 @@ bool EventStore::Open() {
     sqlite3_busy_timeout(db_, 2000);
     Exec("PRAGMA journal_mode=WAL;");
     Exec("PRAGMA synchronous=NORMAL;");
-    return InitSchema();
+    return InitSchema() && PrepareStatements();
 }
 
 void EventStore::Close() {
+    FinalizeStatements();
     if (db_) {
         sqlite3_close(db_);
         db_ = nullptr;
@@ -104,6 +230,48 @@ bool EventStore::Exec(const std::string& sql) {
     return true;
 }
 
+bool EventStore::PrepareStatements() {
+    static_assert(sizeof(kStatementSql) / sizeof(kStatementSql[0]) == static_cast<size_t>(Stmt::Count),
+                  "one SQL string per Stmt");
+    for (size_t i = 0; i < stmts_.size(); ++i) {
+        if (stmts_[i]) {
+            continue;
+        }
+#if SQLITE_VERSION_NUMBER >= 3020000
+        int rc = sqlite3_prepare_v3(db_, kStatementSql[i], -1, SQLITE_PREPARE_PERSISTENT, &stmts_[i], nullptr);
+#else
+        int rc = sqlite3_prepare_v2(db_, kStatementSql[i], -1, &stmts_[i], nullptr);
+#endif
+        if (rc != SQLITE_OK) {
+            std::cerr << "SQLite prepare failed: " << sqlite3_errmsg(db_) << "\n";
+            FinalizeStatements();
+            return false;
+        }
+    }
+    return true;
+}
+
+void EventStore::FinalizeStatements() {
+    for (sqlite3_stmt*& stmt : stmts_) {
+        if (stmt) {
+            sqlite3_finalize(stmt);
+            stmt = nullptr;
+        }
+    }
+}
+
+bool EventStore::Step(Stmt which) {
+    StmtUse stmt(this, which);
+    if (!stmt) {
+        return false;
+    }
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        std::cerr << "SQLite step failed: " << sqlite3_errmsg(db_) << "\n";
+        return false;
+    }
+    return true;
+}
+
 bool EventStore::InitSchema() {
     const char* events_sql =
         "CREATE TABLE IF NOT EXISTS events("
@@ -127,7 +295,80 @@ bool EventStore::InitSchema() {
     const char* index_sql =
         "CREATE INDEX IF NOT EXISTS idx_events_start ON events(start_ts);";
 
-    return Exec(events_sql) && Exec(meta_sql) && Exec(index_sql);
+    // Events per local date, yyyymmdd. Dates are local to the timezone
+    // the rows were written in.
+    const char* days_sql =
+        "CREATE TABLE IF NOT EXISTS event_days("
+        "day INTEGER PRIMARY KEY,"
+        "count INTEGER NOT NULL"
+        ");";
+
+    return Exec(events_sql) && Exec(meta_sql) && Exec(index_sql) && Exec(days_sql) && MigrateSchema();
+}
+
+bool EventStore::MigrateSchema() {
+    int version = 0;
+    if (!ReadUserVersion(db_, &version)) {
+        return false;
+    }
+    if (version >= kSchemaVersion) {
+        return true;
+    }
+
+    // Another connection may be migrating too; check again under the lock.
+    if (!Exec("BEGIN IMMEDIATE;")) {
+        return false;
+    }
+    bool ok = ReadUserVersion(db_, &version);
+    if (ok && version < 1) {
+        // Fill event_days from the rows written before it existed.
+        std::map<int, int> counts;
+        sqlite3_stmt* stmt = nullptr;
+        ok = sqlite3_prepare_v2(db_, "SELECT start_ts, end_ts FROM events WHERE status != 'cancelled'", -1, &stmt,
+                                nullptr) == SQLITE_OK;
+        while (ok && sqlite3_step(stmt) == SQLITE_ROW) {
+            for (int date : EventDates(sqlite3_column_int64(stmt, 0), sqlite3_column_int64(stmt, 1))) {
+                counts[date] += 1;
+            }
+        }
+        sqlite3_finalize(stmt);
+        stmt = nullptr;
+
+        ok = ok && Exec("DELETE FROM event_days;") &&
+             sqlite3_prepare_v2(db_, "INSERT INTO event_days(day, count) VALUES(?, ?)", -1, &stmt, nullptr) == SQLITE_OK;
+        for (auto it = counts.begin(); ok && it != counts.end(); ++it) {
+            sqlite3_bind_int(stmt, 1, it->first);
+            sqlite3_bind_int(stmt, 2, it->second);
+            ok = sqlite3_step(stmt) == SQLITE_DONE;
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+        if (!ok) {
+            std::cerr << "SQLite event_days migration failed: " << sqlite3_errmsg(db_) << "\n";
+        }
+    }
+    ok = ok && Exec("PRAGMA user_version = " + std::to_string(kSchemaVersion) + ";");
+    if (!ok || !Exec("COMMIT;")) {
+        Exec("ROLLBACK;");
+        return false;
+    }
+    return true;
+}
+
+bool EventStore::AddEventDays(int64_t start_ts, int64_t end_ts, int delta) {
+    for (int date : EventDates(start_ts, end_ts)) {
+        StmtUse stmt(this, Stmt::AddDayCount);
+        if (!stmt) {
+            return false;
+        }
+        sqlite3_bind_int(stmt.get(), 1, date);
+        sqlite3_bind_int(stmt.get(), 2, delta);
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            std::cerr << "SQLite day count update failed: " << sqlite3_errmsg(db_) << "\n";
+            return false;
+        }
+    }
+    return true;
 }
 
 bool EventStore::UpsertEvent(const EventRecord& ev) {
@@ -136,20 +377,46 @@ bool EventStore::UpsertEvent(const EventRecord& ev) {
         return false;
     }
 
-    const char* sql =
-        "INSERT INTO events(id, calendar_id, title, start_ts, end_ts, all_day, location, updated_ts, status)"
-        " VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?)"
-        " ON CONFLICT(id) DO UPDATE SET"
-        " calendar_id=excluded.calendar_id,"
-        " title=excluded.title,"
-        " start_ts=excluded.start_ts,"
-        " end_ts=excluded.end_ts,"
-        " all_day=excluded.all_day,"
-        " location=excluded.location,"
-        " updated_ts=excluded.updated_ts,"
-        " status=excluded.status";
-
-    auto stmt = Prepare(db_, sql);
+    // The row and its day buckets change together: inside the caller's
+    // transaction when there is one (ApplySync), otherwise in our own.
+    bool own_transaction = sqlite3_get_autocommit(db_) != 0;
+    if (own_transaction && !Step(Stmt::Begin)) {
+        return false;
+    }
+    if (!UpsertEventRow(ev) || (own_transaction && !Step(Stmt::Commit))) {
+        if (own_transaction) {
+            Step(Stmt::Rollback);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool EventStore::UpsertEventRow(const EventRecord& ev) {
+    // Move the row's day marks only when its span or cancellation changed;
+    // a sync rewrites mostly unchanged events.
+    bool marked_before = false;
+    int64_t old_start = 0;
+    int64_t old_end = 0;
+    {
+        StmtUse span(this, Stmt::EventSpan);
+        if (!span) {
+            return false;
+        }
+        sqlite3_bind_text(span.get(), 1, ev.id.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(span.get()) == SQLITE_ROW) {
+            old_start = sqlite3_column_int64(span.get(), 0);
+            old_end = sqlite3_column_int64(span.get(), 1);
+            marked_before = ColumnText(span.get(), 2) != "cancelled";
+        }
+    }
+    bool marked_after = ev.status != "cancelled";
+    bool days_changed = marked_before != marked_after || old_start != ev.start_ts || old_end != ev.end_ts;
+    if (days_changed && marked_before && !AddEventDays(old_start, old_end, -1)) {
+        return false;
+    }
+
+    StmtUse stmt(this, Stmt::UpsertEvent);
     if (!stmt) {
         return false;
     }
@@ -168,16 +435,11 @@ bool EventStore::UpsertEvent(const EventRecord& ev) {
         std::cerr << "SQLite upsert failed: " << sqlite3_errmsg(db_) << "\n";
         return false;
     }
-    return true;
+    return !days_changed || !marked_after || AddEventDays(ev.start_ts, ev.end_ts, 1);
 }
 
 bool EventStore::GetNextEventAfter(int64_t ts, EventRecord* out) {
-    const char* sql =
-        "SELECT id, calendar_id, title, start_ts, end_ts, all_day, location, updated_ts, status"
-        " FROM events WHERE start_ts >= ? AND status != 'cancelled'"
-        " ORDER BY start_ts ASC LIMIT 1";
-
-    auto stmt = Prepare(db_, sql);
+    StmtUse stmt(this, Stmt::NextEventAfter);
     if (!stmt) {
         return false;
     }
@@ -186,98 +448,127 @@ bool EventStore::GetNextEventAfter(int64_t ts, EventRecord* out) {
 
     int rc = sqlite3_step(stmt.get());
     if (rc == SQLITE_ROW) {
-        out->id = ColumnText(stmt.get(), 0);
-        out->calendar_id = ColumnText(stmt.get(), 1);
-        out->title = ColumnText(stmt.get(), 2);
-        out->start_ts = sqlite3_column_int64(stmt.get(), 3);
-        out->end_ts = sqlite3_column_int64(stmt.get(), 4);
-        out->all_day = sqlite3_column_int(stmt.get(), 5) != 0;
-        out->location = ColumnText(stmt.get(), 6);
-        out->updated_ts = sqlite3_column_int64(stmt.get(), 7);
-        out->status = ColumnText(stmt.get(), 8);
+        ReadEventRow(stmt.get(), out);
         return true;
     }
 
     return false;
 }
 
-std::vector<EventRecord> EventStore::GetEventsForDay(int64_t day_ts) {
-    std::vector<EventRecord> out;
-    int64_t start = TimeUtil::StartOfDay(day_ts);
-    int64_t end = TimeUtil::EndOfDay(day_ts);
-
-    const char* sql =
-        "SELECT id, calendar_id, title, start_ts, end_ts, all_day, location, updated_ts, status"
-        " FROM events WHERE start_ts <= ? AND end_ts >= ? AND status != 'cancelled'"
-        " ORDER BY start_ts ASC";
+bool EventStore::ReadSnapshot(std::vector<EventRecord>* events, std::vector<DayCount>* days) {
+    events->clear();
+    days->clear();
+    if (!Step(Stmt::BeginRead)) {
+        return false;
+    }
+    // A partial read must not pass for the whole table: the caller would
+    // publish it and the views would lose events.
+    if (!ReadSnapshotRows(events, days) || !Step(Stmt::Commit)) {
+        Step(Stmt::Rollback);
+        events->clear();
+        days->clear();
+        return false;
+    }
+    return true;
+}
 
-    auto stmt = Prepare(db_, sql);
+bool EventStore::ReadSnapshotRows(std::vector<EventRecord>* events, std::vector<DayCount>* days) {
+    {
+        StmtUse stmt(this, Stmt::AllEvents);
+        if (!stmt) {
+            return false;
+        }
+        int rc = SQLITE_ROW;
+        while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+            EventRecord ev;
+            ReadEventRow(stmt.get(), &ev);
+            events->push_back(std::move(ev));
+        }
+        if (rc != SQLITE_DONE) {
+            std::cerr << "SQLite snapshot read of events failed: " << sqlite3_errmsg(db_) << "\n";
+            return false;
+        }
+    }
+    StmtUse stmt(this, Stmt::AllEventDays);
     if (!stmt) {
-        return out;
+        return false;
     }
-
-    sqlite3_bind_int64(stmt.get(), 1, end);
-    sqlite3_bind_int64(stmt.get(), 2, start);
-
-    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
-        EventRecord ev;
-        ev.id = ColumnText(stmt.get(), 0);
-        ev.calendar_id = ColumnText(stmt.get(), 1);
-        ev.title = ColumnText(stmt.get(), 2);
-        ev.start_ts = sqlite3_column_int64(stmt.get(), 3);
-        ev.end_ts = sqlite3_column_int64(stmt.get(), 4);
-        ev.all_day = sqlite3_column_int(stmt.get(), 5) != 0;
-        ev.location = ColumnText(stmt.get(), 6);
-        ev.updated_ts = sqlite3_column_int64(stmt.get(), 7);
-        ev.status = ColumnText(stmt.get(), 8);
-        out.push_back(std::move(ev));
-    }
-    return out;
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+        DayCount day;
+        day.date = sqlite3_column_int(stmt.get(), 0);
+        day.count = sqlite3_column_int(stmt.get(), 1);
+        days->push_back(day);
+    }
+    if (rc != SQLITE_DONE) {
+        std::cerr << "SQLite snapshot read of event days failed: " << sqlite3_errmsg(db_) << "\n";
+        return false;
+    }
+    return true;
 }
 
 std::map<int, int> EventStore::GetEventDaysInMonth(int year, int month) {
     std::map<int, int> counts;
-    std::tm tm{};
-    tm.tm_year = year - 1900;
-    tm.tm_mon = month - 1;
-    tm.tm_mday = 1;
-    tm.tm_hour = 0;
-    tm.tm_min = 0;
-    tm.tm_sec = 0;
-
-    int64_t start_ts = std::mktime(&tm);
-    tm.tm_mday = TimeUtil::DaysInMonth(year, month);
-    tm.tm_hour = 23;
-    tm.tm_min = 59;
-    tm.tm_sec = 59;
-    int64_t end_ts = std::mktime(&tm);
-
-    const char* sql =
-        "SELECT start_ts FROM events WHERE start_ts >= ? AND start_ts <= ? AND status != 'cancelled'";
-
-    auto stmt = Prepare(db_, sql);
+    StmtUse stmt(this, Stmt::EventDaysInMonth);
     if (!stmt) {
         return counts;
     }
 
-    sqlite3_bind_int64(stmt.get(), 1, start_ts);
-    sqlite3_bind_int64(stmt.get(), 2, end_ts);
+    int first = year * 10000 + month * 100 + 1;
+    sqlite3_bind_int(stmt.get(), 1, first);
+    sqlite3_bind_int(stmt.get(), 2, first + 30);
 
     while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
-        int64_t ts = sqlite3_column_int64(stmt.get(), 0);
-        std::tm local = TimeUtil::LocalTime(ts);
-        counts[local.tm_mday] += 1;
+        counts[sqlite3_column_int(stmt.get(), 0) % 100] = sqlite3_column_int(stmt.get(), 1);
     }
     return counts;
 }
 
 bool EventStore::DeleteStaleInWindow(const std::string& calendar_id, int64_t window_start, int64_t window_end, int64_t min_updated_ts) {
-    const char* sql =
-        "DELETE FROM events WHERE calendar_id = ?"
-        " AND start_ts <= ? AND end_ts >= ?"
-        " AND updated_ts < ?";
+    // Same transaction rule as UpsertEvent.
+    bool own_transaction = sqlite3_get_autocommit(db_) != 0;
+    if (own_transaction && !Step(Stmt::Begin)) {
+        return false;
+    }
+    if (!DeleteStaleRows(calendar_id, window_start, window_end, min_updated_ts) ||
+        (own_transaction && !Step(Stmt::Commit))) {
+        if (own_transaction) {
+            Step(Stmt::Rollback);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool EventStore::DeleteStaleRows(const std::string& calendar_id, int64_t window_start, int64_t window_end, int64_t min_updated_ts) {
+    std::vector<std::pair<int64_t, int64_t>> spans;
+    {
+        StmtUse stale(this, Stmt::StaleSpans);
+        if (!stale) {
+            return false;
+        }
+        sqlite3_bind_text(stale.get(), 1, calendar_id.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stale.get(), 2, window_end);
+        sqlite3_bind_int64(stale.get(), 3, window_start);
+        sqlite3_bind_int64(stale.get(), 4, min_updated_ts);
+        int rc = SQLITE_ROW;
+        while ((rc = sqlite3_step(stale.get())) == SQLITE_ROW) {
+            if (ColumnText(stale.get(), 2) != "cancelled") {
+                spans.emplace_back(sqlite3_column_int64(stale.get(), 0), sqlite3_column_int64(stale.get(), 1));
+            }
+        }
+        if (rc != SQLITE_DONE) {
+            std::cerr << "SQLite stale span read failed: " << sqlite3_errmsg(db_) << "\n";
+            return false;
+        }
+    }
+    for (const auto& span : spans) {
+        if (!AddEventDays(span.first, span.second, -1)) {
+            return false;
+        }
+    }
 
-    auto stmt = Prepare(db_, sql);
+    StmtUse stmt(this, Stmt::DeleteStale);
     if (!stmt) {
         return false;
     }
@@ -294,17 +585,31 @@ bool EventStore::DeleteStaleInWindow(const std::string& calendar_id, int64_t win
     return true;
 }
 
+bool EventStore::ApplySync(const std::string& calendar_id, const std::vector<EventRecord>& events, const SyncWindow& window) {
+    if (!Step(Stmt::Begin)) {
+        return false;
+    }
+    for (const EventRecord& ev : events) {
+        if (ev.calendar_id != calendar_id || ev.updated_ts != window.sync_ts || !UpsertEvent(ev)) {
+            std::cerr << "SQLite sync of " << calendar_id << " rolled back at event " << ev.id << "\n";
+            Step(Stmt::Rollback);
+            return false;
+        }
+    }
+    if (!DeleteStaleInWindow(calendar_id, window.start_ts, window.end_ts, window.sync_ts) || !Step(Stmt::Commit)) {
+        Step(Stmt::Rollback);
+        return false;
+    }
+    return true;
+}
+
 bool EventStore::SetMeta(const std::string& key, const std::string& value) {
     if (!IsValidMetaEntry(key, value)) {
         std::cerr << "SQLite set meta rejected malformed input.\n";
         return false;
     }
 
-    const char* sql =
-        "INSERT INTO meta(key, value) VALUES(?, ?)"
-        " ON CONFLICT(key) DO UPDATE SET value=excluded.value";
-
-    auto stmt = Prepare(db_, sql);
+    StmtUse stmt(this, Stmt::SetMeta);
     if (!stmt) {
         return false;
     }
@@ -320,8 +625,7 @@ bool EventStore::SetMeta(const std::string& key, const std::string& value) {
 }
 
 std::string EventStore::GetMeta(const std::string& key) {
-    const char* sql = "SELECT value FROM meta WHERE key = ?";
-    auto stmt = Prepare(db_, sql);
+    StmtUse stmt(this, Stmt::GetMeta);
     if (!stmt) {
         return "";
     }
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
 
 struct sqlite3;
+struct sqlite3_stmt;
 
 struct EventRecord {
     std::string id;
@@ -19,6 +21,20 @@ struct EventRecord {
     std::string status;
 };
 
+// How many events touch one local calendar date, `date` being yyyymmdd.
+struct DayCount {
+    int date = 0;
+    int count = 0;
+};
+
+// The span a calendar sync covers, and the stamp it writes into every
+// event it delivers.
+struct SyncWindow {
+    int64_t start_ts = 0;
+    int64_t end_ts = 0;
+    int64_t sync_ts = 0;
+};
+
 class EventStore {
 public:
     explicit EventStore(const std::string& db_path);
@@ -30,9 +46,21 @@ public:
 
     bool UpsertEvent(const EventRecord& ev);
     bool GetNextEventAfter(int64_t ts, EventRecord* out);
-    std::vector<EventRecord> GetEventsForDay(int64_t day_ts);
+    // Day of month -> events on that local date, read from the event_days
+    // buckets that every write keeps current. An event counts on each date
+    // from its start through its last second.
     std::map<int, int> GetEventDaysInMonth(int year, int month);
+    // Everything an EventSnapshot holds, read in one transaction: every
+    // event that is not cancelled by start time then id, and every date
+    // with events in order.
+    bool ReadSnapshot(std::vector<EventRecord>* events, std::vector<DayCount>* days);
     bool DeleteStaleInWindow(const std::string& calendar_id, int64_t window_start, int64_t window_end, int64_t min_updated_ts);
+    // Applies one sync of `calendar_id` as a single transaction: upserts
+    // `events` (all must belong to that calendar, with updated_ts set to
+    // window.sync_ts), then deletes its events in the window this sync did
+    // not deliver. Readers see the previous or the new state, never a mix;
+    // if any event is rejected nothing changes.
+    bool ApplySync(const std::string& calendar_id, const std::vector<EventRecord>& events, const SyncWindow& window);
 
     bool SetMeta(const std::string& key, const std::string& value);
     std::string GetMeta(const std::string& key);
@@ -40,8 +68,40 @@ public:
     bool InsertSampleEvents(int64_t now_ts);
 
 private:
+    // Every statement the store runs, prepared once per connection in Open
+    // and reset after each use instead of being re-parsed per call.
+    enum class Stmt {
+        UpsertEvent,
+        NextEventAfter,
+        EventDaysInMonth,
+        AllEvents,
+        AllEventDays,
+        EventSpan,
+        StaleSpans,
+        AddDayCount,
+        DeleteStale,
+        SetMeta,
+        GetMeta,
+        Begin,
+        BeginRead,
+        Commit,
+        Rollback,
+        Count
+    };
+
+    class StmtUse;
+
     bool Exec(const std::string& sql);
+    bool Step(Stmt which);
+    bool MigrateSchema();
+    bool UpsertEventRow(const EventRecord& ev);
+    bool ReadSnapshotRows(std::vector<EventRecord>* events, std::vector<DayCount>* days);
+    bool DeleteStaleRows(const std::string& calendar_id, int64_t window_start, int64_t window_end, int64_t min_updated_ts);
+    bool AddEventDays(int64_t start_ts, int64_t end_ts, int delta);
+    bool PrepareStatements();
+    void FinalizeStatements();
 
     std::string db_path_;
     sqlite3* db_ = nullptr;
+    std::array<sqlite3_stmt*, static_cast<size_t>(Stmt::Count)> stmts_{};
 };
@@ -0,0 +1,26 @@
+#include "db/MetaSnapshot.h"
+
+#include "db/EventStore.h"
+
+#include <utility>
+
+MetaSnapshot::MetaSnapshot(std::map<std::string, std::string> values)
+    : values_(std::move(values)) {
+}
+
+std::shared_ptr<const MetaSnapshot> MetaSnapshot::Load(EventStore* store, const std::vector<std::string>& keys) {
+    std::map<std::string, std::string> values;
+    for (const std::string& key : keys) {
+        std::string value = store->GetMeta(key);
+        if (!value.empty()) {
+            values.emplace(key, std::move(value));
+        }
+    }
+    return std::make_shared<const MetaSnapshot>(std::move(values));
+}
+
+const std::string& MetaSnapshot::Get(const std::string& key) const {
+    static const std::string kEmpty;
+    auto it = values_.find(key);
+    return it == values_.end() ? kEmpty : it->second;
+}
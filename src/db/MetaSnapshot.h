@@ -0,0 +1,31 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/SnapshotSlot.h"
+
+class EventStore;
+
+// Immutable copy of the meta values one sync service writes. The service
+// publishes a new one after each pass, so the views read sync and weather
+// status without querying the meta table on the render thread.
+class MetaSnapshot {
+public:
+    MetaSnapshot() = default;
+    explicit MetaSnapshot(std::map<std::string, std::string> values);
+
+    // Reads `keys` from the store; keys without a row read as empty.
+    static std::shared_ptr<const MetaSnapshot> Load(EventStore* store, const std::vector<std::string>& keys);
+
+    // Empty when the key is unset, like EventStore::GetMeta.
+    const std::string& Get(const std::string& key) const;
+
+private:
+    std::map<std::string, std::string> values_;
+};
+
+// The slot a sync service publishes its meta values through.
+class MetaSnapshotSlot : public SnapshotSlot<MetaSnapshot> {};
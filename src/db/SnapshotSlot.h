@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+// Hands snapshots from the sync threads to the render thread without a
+// lock. Publish parks the new snapshot in a single atomic pointer; Current
+// takes whatever is parked there and keeps it as the reader's own
+// reference. Whichever side swaps a parked snapshot out owns it, so a
+// snapshot replaced before it was read is freed by the publisher, and one
+// that was read is released on the render thread when the next one is
+// taken. Neither side ever waits on the other or on the database.
+//
+// Any thread may Publish; Current must only be called from one thread.
+template <typename Snapshot>
+class SnapshotSlot {
+public:
+    SnapshotSlot() = default;
+    SnapshotSlot(const SnapshotSlot&) = delete;
+    SnapshotSlot& operator=(const SnapshotSlot&) = delete;
+
+    ~SnapshotSlot() {
+        delete pending_.load(std::memory_order_acquire);
+    }
+
+    void Publish(std::shared_ptr<const Snapshot> snapshot) {
+        if (!snapshot) {
+            snapshot = std::make_shared<const Snapshot>();
+        }
+        auto* parked = new std::shared_ptr<const Snapshot>(std::move(snapshot));
+        delete pending_.exchange(parked, std::memory_order_acq_rel);
+    }
+
+    // Never null: an empty snapshot until the first Publish.
+    std::shared_ptr<const Snapshot> Current() const {
+        if (std::shared_ptr<const Snapshot>* parked = pending_.exchange(nullptr, std::memory_order_acq_rel)) {
+            current_ = std::move(*parked);
+            delete parked;
+        }
+        return current_;
+    }
+
+private:
+    static_assert(std::atomic<std::shared_ptr<const Snapshot>*>::is_always_lock_free,
+                  "the handoff must not fall back to a lock");
+
+    // Published but not yet taken by the reader; owned by the slot.
+    mutable std::atomic<std::shared_ptr<const Snapshot>*> pending_{nullptr};
+    // The reader's reference, only touched by the thread calling Current.
+    mutable std::shared_ptr<const Snapshot> current_ = std::make_shared<const Snapshot>();
+};
@@ -5,8 +5,18 @@
 
 #include <nlohmann/json.hpp>
 
+#include "db/EventSnapshot.h"
 #include "db/EventStore.h"
+#include "db/MetaSnapshot.h"
+#include "render/AssetLoader.h"
+#include "render/AssetPack.h"
+#include "render/Compositor.h"
+#include "render/DebugHud.h"
+#include "render/FontRegistry.h"
+#include "render/FrameProfiler.h"
+#include "render/TextRenderer.h"
 #include "services/CalendarSyncService.h"
+#include "services/SnapshotService.h"
 #include "services/WeatherSyncService.h"
 #include "util/TimeUtil.h"
 #include "views/CalendarView.h"
@@ -17,16 +27,21 @@
 #include <chrono>
 #include <cctype>
 #include <cmath>
+#include <ctime>
 #include <filesystem>
 #include <fstream>
 #include <cstdlib>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <vector>
 
 namespace {
 
 constexpr size_t kMaxConfigBytes = 64 * 1024;
 constexpr size_t kMaxPathBytes = 512;
+constexpr size_t kMaxFontFallbacks = 8;
 constexpr size_t kMaxUrlBytes = 2048;
 
 std::string Trim(const std::string& value) {
@@ -143,6 +158,28 @@ bool ReadPathString(const nlohmann::json& j, const char* key, size_t max_bytes,
     return true;
 }
 
+bool ReadPathList(const nlohmann::json& j, const char* key, size_t max_items, size_t max_bytes, std::vector<std::string>* out) {
+    if (!j.contains(key)) {
+        return true;
+    }
+    const auto& value = j.at(key);
+    if (!value.is_array() || value.size() > max_items) {
+        std::cerr << "Config key '" << key << "' must be an array of at most " << max_items << " paths.\n";
+        return false;
+    }
+    std::vector<std::string> parsed;
+    for (const auto& item : value) {
+        std::string path = item.is_string() ? Trim(item.get<std::string>()) : std::string();
+        if (path.empty() || path.size() > max_bytes || ContainsControlChars(path)) {
+            std::cerr << "Config key '" << key << "' has a malformed or too large entry.\n";
+            return false;
+        }
+        parsed.push_back(std::move(path));
+    }
+    *out = std::move(parsed);
+    return true;
+}
+
 std::filesystem::path ResolvePath(const std::filesystem::path& config_path,
                                   const std::string& value,
                                   bool allow_parent_fallback) {
@@ -171,6 +208,125 @@ std::filesystem::path ResolvePath(const std::filesystem::path& config_path,
     return candidate;
 }
 
+// Wall-clock milliseconds until the next minute boundary, plus a little slack so
+// that TimeUtil::NowTs() has definitely rolled over when we wake up.
+int MsUntilNextMinute() {
+    constexpr int64_t kSlackMs = 5;
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+    return static_cast<int>(60000 - (now_ms % 60000) + kSlackMs);
+}
+
+// Same as MsUntilNextMinute, for the clock's seconds display.
+int MsUntilNextSecond() {
+    constexpr int64_t kSlackMs = 5;
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+    return static_cast<int>(1000 - (now_ms % 1000) + kSlackMs);
+}
+
+// Tracks how often the main loop wakes and renders, and how much CPU the
+// process burns in between, so the idle cost can be read from the log.
+class LoopStats {
+public:
+    LoopStats() { Reset(); }
+
+    // Every return from the wait counts; `timed_out` ones came from a tick
+    // or deadline the loop scheduled itself rather than from an event.
+    void OnWakeup(bool timed_out) {
+        ++wakeups_;
+        if (timed_out) {
+            ++timeouts_;
+        }
+    }
+    void OnFrame() { ++frames_; }
+
+    void MaybeReport() {
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - window_start_).count();
+        if (elapsed < kReportIntervalSec) {
+            return;
+        }
+        double wall_sec = std::chrono::duration<double>(now - window_start_).count();
+        double cpu_sec = static_cast<double>(std::clock() - cpu_start_) / CLOCKS_PER_SEC;
+        double cpu_pct = wall_sec > 0.0 ? (cpu_sec / wall_sec) * 100.0 : 0.0;
+        std::cout << "Main loop: " << frames_ << " frames, " << wakeups_ << " wakeups (" << timeouts_ << " timeouts) in "
+                  << static_cast<int>(wall_sec) << "s, process CPU "
+                  << std::fixed << std::setprecision(2) << cpu_pct << "%\n" << std::flush;
+        Reset();
+    }
+
+private:
+    static constexpr int64_t kReportIntervalSec = 600;
+
+    void Reset() {
+        window_start_ = std::chrono::steady_clock::now();
+        cpu_start_ = std::clock();
+        wakeups_ = 0;
+        timeouts_ = 0;
+        frames_ = 0;
+    }
+
+    std::chrono::steady_clock::time_point window_start_;
+    std::clock_t cpu_start_ = 0;
+    uint64_t wakeups_ = 0;
+    uint64_t timeouts_ = 0;
+    uint64_t frames_ = 0;
+};
+
+// Night dimming as render state: the day/night decision is only re-evaluated
+// when the local hour changes, not on every frame.
+class NightMode {
+public:
+    NightMode(bool enabled, int start_hour, int end_hour, int dim_alpha)
+        : enabled_(enabled), start_hour_(start_hour), end_hour_(end_hour),
+          dim_alpha_(std::min(255, std::max(0, dim_alpha))) {}
+
+    // Returns true when the night state flipped.
+    bool Update(int64_t now_ts) {
+        if (!enabled_ || now_ts < next_check_ts_) {
+            return false;
+        }
+        std::tm tm = TimeUtil::LocalTime(now_ts);
+        bool was_night = is_night_;
+        is_night_ = IsNightHour(tm.tm_hour);
+
+        tm.tm_hour += 1;
+        tm.tm_min = 0;
+        tm.tm_sec = 0;
+        tm.tm_isdst = -1;
+        next_check_ts_ = std::mktime(&tm);
+        if (next_check_ts_ <= now_ts) {
+            next_check_ts_ = now_ts + 60;
+        }
+        return was_night != is_night_;
+    }
+
+    bool IsNight() const { return is_night_; }
+
+    Uint8 DimLevel() const {
+        return is_night_ ? static_cast<Uint8>(255 - dim_alpha_) : static_cast<Uint8>(255);
+    }
+
+private:
+    bool IsNightHour(int hour) const {
+        if (start_hour_ == end_hour_) {
+            return false;
+        }
+        if (start_hour_ < end_hour_) {
+            return hour >= start_hour_ && hour < end_hour_;
+        }
+        return hour >= start_hour_ || hour < end_hour_;
+    }
+
+    bool enabled_;
+    int start_hour_;
+    int end_hour_;
+    int dim_alpha_;
+    bool is_night_ = false;
+    int64_t next_check_ts_ = 0;
+};
+
 class CurlGlobalGuard {
 public:
     CurlGlobalGuard() : initialized_(curl_global_init(CURL_GLOBAL_DEFAULT) == 0) {}
@@ -194,7 +350,17 @@ struct AppConfig {
     int night_start_hour = 21;
     int night_end_hour = 6;
     int night_dim_alpha = 110;
+    int day_frame_interval_ms = 33;
+    int night_frame_interval_ms = 250;
+    bool clock_show_seconds = false;
+    int text_atlas_size = 1024;
+    int text_cache_kb = 256;
+    bool clock_blink_colon = false;
     std::string font_path = "./assets/DejaVuSans.ttf";
+    // Tried in order for codepoints font_path has no glyph for.
+    std::vector<std::string> font_fallbacks;
+    // Optional; assets not found in the pack are read from their own files.
+    std::string asset_pack;
     std::string db_path = "./data/calendar.db";
     bool mock_mode = true;
     std::string ics_url;
@@ -204,6 +370,9 @@ struct AppConfig {
     int weather_sync_interval_sec = 900;
     std::string weather_sprite_dir = "./assets/weather";
     std::string sprite_dir = "./assets/sprites";
+    std::string screenshot_path = "./data/preview.png";
+    std::string snapshot_path = "./data/snapshot.png";
+    int snapshot_interval_sec = 0;
 };
 
 bool LoadConfig(const std::string& path, AppConfig* out) {
@@ -230,16 +399,27 @@ bool LoadConfig(const std::string& path, AppConfig* out) {
         !ReadIntInRange(j, "night_start_hour", 0, 23, &out->night_start_hour) ||
         !ReadIntInRange(j, "night_end_hour", 0, 23, &out->night_end_hour) ||
         !ReadIntInRange(j, "night_dim_alpha", 0, 255, &out->night_dim_alpha) ||
+        !ReadIntInRange(j, "day_frame_interval_ms", 0, 5000, &out->day_frame_interval_ms) ||
+        !ReadIntInRange(j, "night_frame_interval_ms", 0, 5000, &out->night_frame_interval_ms) ||
         !ReadIntInRange(j, "weather_sync_interval_sec", 60, 24 * 60 * 60, &out->weather_sync_interval_sec) ||
+        !ReadIntInRange(j, "text_atlas_size", 256, 4096, &out->text_atlas_size) ||
+        !ReadIntInRange(j, "text_cache_kb", 16, 64 * 1024, &out->text_cache_kb) ||
+        !ReadIntInRange(j, "snapshot_interval_sec", 0, 24 * 60 * 60, &out->snapshot_interval_sec) ||
         !ReadBool(j, "night_mode_enabled", &out->night_mode_enabled) ||
         !ReadBool(j, "weather_enabled", &out->weather_enabled) ||
         !ReadBool(j, "mock_mode", &out->mock_mode) ||
+        !ReadBool(j, "clock_show_seconds", &out->clock_show_seconds) ||
+        !ReadBool(j, "clock_blink_colon", &out->clock_blink_colon) ||
         !ReadDoubleInRange(j, "weather_latitude", -90.0, 90.0, &out->weather_latitude) ||
         !ReadDoubleInRange(j, "weather_longitude", -180.0, 180.0, &out->weather_longitude) ||
         !ReadPathString(j, "font_path", kMaxPathBytes, &out->font_path) ||
+        !ReadPathList(j, "font_fallbacks", kMaxFontFallbacks, kMaxPathBytes, &out->font_fallbacks) ||
+        !ReadPathString(j, "asset_pack", kMaxPathBytes, &out->asset_pack) ||
         !ReadPathString(j, "db_path", kMaxPathBytes, &out->db_path) ||
         !ReadPathString(j, "weather_sprite_dir", kMaxPathBytes, &out->weather_sprite_dir) ||
-        !ReadPathString(j, "sprite_dir", kMaxPathBytes, &out->sprite_dir)) {
+        !ReadPathString(j, "sprite_dir", kMaxPathBytes, &out->sprite_dir) ||
+        !ReadPathString(j, "screenshot_path", kMaxPathBytes, &out->screenshot_path) ||
+        !ReadPathString(j, "snapshot_path", kMaxPathBytes, &out->snapshot_path)) {
         return false;
     }
 
@@ -278,9 +458,15 @@ int main(int argc, char** argv) {
 
     std::filesystem::path config_abs = std::filesystem::absolute(config_path);
     config.font_path = ResolvePath(config_abs, config.font_path, true).string();
+    for (std::string& fallback : config.font_fallbacks) {
+        fallback = ResolvePath(config_abs, fallback, true).string();
+    }
+    config.asset_pack = ResolvePath(config_abs, config.asset_pack, true).string();
     config.sprite_dir = ResolvePath(config_abs, config.sprite_dir, true).string();
     config.weather_sprite_dir = ResolvePath(config_abs, config.weather_sprite_dir, true).string();
     config.db_path = ResolvePath(config_abs, config.db_path, true).string();
+    config.screenshot_path = ResolvePath(config_abs, config.screenshot_path, true).string();
+    config.snapshot_path = ResolvePath(config_abs, config.snapshot_path, true).string();
 
     std::filesystem::create_directories(std::filesystem::path(config.db_path).parent_path());
 
@@ -290,12 +476,42 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    // The views read events, sync status and weather only from these. Start
+    // from what the last run cached (empty if that cannot be read); the sync
+    // threads publish new snapshots after every sync.
+    EventSnapshotSlot events;
+    events.Publish(EventSnapshot::Load(&store));
+    MetaSnapshotSlot sync_status;
+    sync_status.Publish(MetaSnapshot::Load(&store, CalendarSyncService::StatusMetaKeys()));
+    MetaSnapshotSlot weather;
+    weather.Publish(MetaSnapshot::Load(&store, WeatherSyncService::MetaKeys()));
+
+    // Worker threads wake the main loop through these events: sync threads
+    // once they have written new data, the asset loader once a sprite set
+    // is ready to upload. SDL_PushEvent is safe to call from any thread.
+    auto make_notifier = [](Uint32 type) {
+        return [type]() {
+            if (type == static_cast<Uint32>(-1)) {
+                return;
+            }
+            SDL_Event ev{};
+            ev.type = type;
+            SDL_PushEvent(&ev);
+        };
+    };
+    Uint32 data_changed_event = SDL_RegisterEvents(1);
+    auto notify_data_changed = make_notifier(data_changed_event);
+    Uint32 assets_ready_event = SDL_RegisterEvents(1);
+
     SyncConfig sync_config;
     sync_config.db_path = config.db_path;
     sync_config.sync_interval_sec = config.sync_interval_sec;
     sync_config.time_window_days = config.time_window_days;
     sync_config.mock_mode = config.mock_mode;
     sync_config.ics_url = config.ics_url;
+    sync_config.events = &events;
+    sync_config.status = &sync_status;
+    sync_config.on_data_changed = notify_data_changed;
 
     CurlGlobalGuard curl_guard;
     if (!curl_guard.IsInitialized()) {
@@ -304,7 +520,6 @@ int main(int argc, char** argv) {
     }
 
     CalendarSyncService sync_service(sync_config);
-    sync_service.Start();
 
     WeatherConfig weather_config;
     weather_config.db_path = config.db_path;
@@ -312,9 +527,16 @@ int main(int argc, char** argv) {
     weather_config.latitude = config.weather_latitude;
     weather_config.longitude = config.weather_longitude;
     weather_config.sync_interval_sec = std::max(60, config.weather_sync_interval_sec);
+    weather_config.weather = &weather;
+    weather_config.on_data_changed = notify_data_changed;
 
     WeatherSyncService weather_service(weather_config);
-    weather_service.Start();
+
+    SnapshotConfig snapshot_config;
+    snapshot_config.screenshot_path = config.screenshot_path;
+    snapshot_config.snapshot_path = config.snapshot_path;
+    snapshot_config.interval_sec = config.snapshot_interval_sec;
+    SnapshotService snapshot_service(snapshot_config);
 
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
@@ -347,7 +569,7 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE);
     if (!renderer) {
         std::cerr << "SDL_CreateRenderer failed: " << SDL_GetError() << "\n";
         SDL_DestroyWindow(window);
@@ -356,23 +578,30 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    TTF_Font* font_time = TTF_OpenFont(config.font_path.c_str(), 80);
-    TTF_Font* font_date = TTF_OpenFont(config.font_path.c_str(), 18);
-    TTF_Font* font_info = TTF_OpenFont(config.font_path.c_str(), 16);
-    TTF_Font* font_header = TTF_OpenFont(config.font_path.c_str(), 18);
-    TTF_Font* font_day = TTF_OpenFont(config.font_path.c_str(), 16);
-    TTF_Font* font_agenda = TTF_OpenFont(config.font_path.c_str(), 16);
-    TTF_Font* font_weather_temp = TTF_OpenFont(config.font_path.c_str(), 50);
-
-    if (!font_time || !font_date || !font_info || !font_header || !font_day || !font_agenda || !font_weather_temp) {
+    // The font and pre-decoded sprites, mapped from one file when configured.
+    AssetPack asset_pack;
+    if (!config.asset_pack.empty() && !asset_pack.Open(config.asset_pack)) {
+        std::cerr << "Continuing with loose asset files.\n";
+    }
+
+    // Faces open on first use; duplicate sizes share one face and all of
+    // them read from a single mapping of the font file (or the pack).
+    FontRegistry font_registry;
+    font_registry.UsePack(asset_pack.IsOpen() ? &asset_pack : nullptr);
+    font_registry.SetFallbacks(config.font_fallbacks);
+    FontHandle font_time = font_registry.Register(config.font_path, 80);
+    FontHandle font_date = font_registry.Register(config.font_path, 18);
+    FontHandle font_info = font_registry.Register(config.font_path, 16);
+    FontHandle font_header = font_registry.Register(config.font_path, 18);
+    FontHandle font_day = font_registry.Register(config.font_path, 16);
+    FontHandle font_agenda = font_registry.Register(config.font_path, 16);
+    FontHandle font_weather_temp = font_registry.Register(config.font_path, 50);
+
+    // The clock face is needed for the very first frame; opening it here
+    // also catches a missing or unreadable font file at startup.
+    if (!font_time.Get()) {
         std::cerr << "Failed to load font: " << config.font_path << "\n";
-        if (font_time) TTF_CloseFont(font_time);
-        if (font_date) TTF_CloseFont(font_date);
-        if (font_info) TTF_CloseFont(font_info);
-        if (font_header) TTF_CloseFont(font_header);
-        if (font_day) TTF_CloseFont(font_day);
-        if (font_agenda) TTF_CloseFont(font_agenda);
-        if (font_weather_temp) TTF_CloseFont(font_weather_temp);
+        font_registry.CloseAll();
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         TTF_Quit();
@@ -380,155 +609,318 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    // Sprite PNGs are decoded on this loader's thread, so the first frame
+    // does not wait for them. It only wakes the loop: each view polls its
+    // own atlas in Prepare, so a finished set redraws just the view that
+    // owns it and no view re-reads its snapshots.
+    AssetLoader asset_loader(make_notifier(assets_ready_event), asset_pack.IsOpen() ? &asset_pack : nullptr);
+    asset_loader.Start();
+
     {
-        ClockView clock_view(renderer, font_time, font_date, font_info, &store, config.sprite_dir);
-        CalendarView calendar_view(renderer, font_header, font_day, font_agenda, &store);
-        WeatherView weather_view(renderer, font_header, font_info, font_weather_temp, &store, config.weather_sprite_dir);
+        TextRenderer text_renderer(renderer, config.text_atlas_size, static_cast<size_t>(config.text_cache_kb) * 1024);
+        text_renderer.UseFonts(&font_registry);
+        ClockView clock_view(renderer, &text_renderer, font_time, font_date, font_info, &events, &sync_status,
+                             &weather, config.sprite_dir, &asset_loader);
+        clock_view.SetSecondsMode(config.clock_show_seconds, config.clock_blink_colon);
+        CalendarView calendar_view(renderer, &text_renderer, font_header, font_day, font_agenda, &events, &sync_status);
+        WeatherView weather_view(renderer, &text_renderer, font_header, font_info, font_weather_temp, &weather, config.weather_sprite_dir,
+                                 &asset_loader);
+        Compositor compositor(renderer);
+        FrameProfiler profiler;
+        DebugHud debug_hud(renderer, font_info);
+        bool show_hud = false;
+        constexpr int kHudRefreshMs = 1000;
+        NightMode night_mode(config.night_mode_enabled, config.night_start_hour, config.night_end_hour, config.night_dim_alpha);
+        auto last_frame_time = std::chrono::steady_clock::now() - std::chrono::hours(1);
 
         enum class ViewMode { Clock, Calendar, Weather };
         ViewMode current_view = ViewMode::Clock;
+        auto next_view_mode = [](ViewMode mode) {
+            if (mode == ViewMode::Clock) {
+                return ViewMode::Calendar;
+            }
+            if (mode == ViewMode::Calendar) {
+                return ViewMode::Weather;
+            }
+            return ViewMode::Clock;
+        };
+        auto view_for = [&](ViewMode mode) -> LayeredView* {
+            if (mode == ViewMode::Calendar) {
+                return &calendar_view;
+            }
+            if (mode == ViewMode::Weather) {
+                return &weather_view;
+            }
+            return &clock_view;
+        };
+
+        // Services start once the SDL event queue exists so their
+        // data-changed notifications are never pushed into the void.
+        sync_service.Start();
+        weather_service.Start();
+        snapshot_service.Start();
 
         auto last_input = std::chrono::steady_clock::now();
         bool capture_next_frame = false;
-
+        bool capture_periodic = false;
         bool running = true;
+        bool needs_redraw = true;
+        // Set whenever the next view in the cycle may be stale; serviced when
+        // the loop would otherwise go back to sleep.
+        bool prewarm_pending = true;
+        int64_t last_rendered_minute = -1;
+        int64_t last_rendered_ts = -1;
+        LoopStats loop_stats;
+
+        auto handle_event = [&](const SDL_Event& ev) {
+            if (ev.type == SDL_QUIT) {
+                running = false;
+            } else if (ev.type == data_changed_event) {
+                clock_view.Invalidate();
+                calendar_view.Invalidate();
+                weather_view.Invalidate();
+                needs_redraw = true;
+                prewarm_pending = true;
+            } else if (ev.type == assets_ready_event) {
+                // The finished set may belong to the next view in the cycle.
+                needs_redraw = true;
+                prewarm_pending = true;
+            } else if (ev.type == SDL_WINDOWEVENT) {
+                needs_redraw = true;
+                prewarm_pending = true;
+            } else if (ev.type == SDL_RENDER_TARGETS_RESET || ev.type == SDL_RENDER_DEVICE_RESET) {
+                bool device_lost = ev.type == SDL_RENDER_DEVICE_RESET;
+                if (device_lost) {
+                    text_renderer.Reset();
+                    compositor.DestroyAll();
+                    debug_hud.Reset();
+                }
+                clock_view.OnRenderReset(device_lost);
+                calendar_view.OnRenderReset(device_lost);
+                weather_view.OnRenderReset(device_lost);
+                compositor.InvalidateAll();
+                needs_redraw = true;
+                prewarm_pending = true;
+            } else if (ev.type == SDL_KEYDOWN) {
+                last_input = std::chrono::steady_clock::now();
+                needs_redraw = true;
+                switch (ev.key.keysym.sym) {
+                    case SDLK_ESCAPE:
+                        running = false;
+                        break;
+                    case SDLK_SPACE:
+                        current_view = next_view_mode(current_view);
+                        prewarm_pending = true;
+                        break;
+                    case SDLK_s:
+                        capture_next_frame = true;
+                        needs_redraw = true;
+                        break;
+                    case SDLK_d:
+                        show_hud = !show_hud;
+                        break;
+                    case SDLK_LEFT:
+                        if (current_view == ViewMode::Calendar) {
+                            calendar_view.MoveSelectionDays(-1);
+                        }
+                        break;
+                    case SDLK_RIGHT:
+                        if (current_view == ViewMode::Calendar) {
+                            calendar_view.MoveSelectionDays(1);
+                        }
+                        break;
+                    case SDLK_UP:
+                        if (current_view == ViewMode::Calendar) {
+                            calendar_view.MoveSelectionDays(-7);
+                        }
+                        break;
+                    case SDLK_DOWN:
+                        if (current_view == ViewMode::Calendar) {
+                            calendar_view.MoveSelectionDays(7);
+                        }
+                        break;
+                    case SDLK_n:
+                        if (current_view == ViewMode::Calendar) {
+                            calendar_view.MoveMonth(1);
+                        }
+                        break;
+                    case SDLK_m:
+                        if (current_view == ViewMode::Calendar) {
+                            calendar_view.MoveMonth(-1);
+                        }
+                        break;
+                    case SDLK_t:
+                        if (current_view == ViewMode::Calendar) {
+                            calendar_view.JumpToToday();
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+        };
+
         while (running) {
+            // Sleep until input, a data-changed notification, the next minute
+            // boundary or the idle timeout, whichever comes first.
+            int timeout_ms = MsUntilNextMinute();
+            if (current_view != ViewMode::Clock) {
+                auto idle_deadline = last_input + std::chrono::seconds(config.idle_threshold_sec);
+                auto until_idle = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    idle_deadline - std::chrono::steady_clock::now()).count();
+                timeout_ms = static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(timeout_ms, until_idle)));
+            }
+            bool clock_ticking = current_view == ViewMode::Clock && clock_view.TicksEverySecond();
+            if (clock_ticking) {
+                timeout_ms = std::min(timeout_ms, MsUntilNextSecond());
+            }
+            if (show_hud) {
+                timeout_ms = std::min(timeout_ms, kHudRefreshMs);
+            }
+            int until_snapshot = snapshot_service.MsUntilPeriodic(std::chrono::steady_clock::now());
+            if (until_snapshot >= 0) {
+                timeout_ms = std::min(timeout_ms, until_snapshot);
+            }
+            // Pending redraws are coalesced into the current frame budget,
+            // which is much lower while night mode is active.
+            auto frame_interval = std::chrono::milliseconds(
+                night_mode.IsNight() ? config.night_frame_interval_ms : config.day_frame_interval_ms);
+            auto until_frame_budget = std::chrono::duration_cast<std::chrono::milliseconds>(
+                last_frame_time + frame_interval - std::chrono::steady_clock::now()).count();
+            if (needs_redraw) {
+                timeout_ms = static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(timeout_ms, until_frame_budget)));
+            } else if (prewarm_pending) {
+                timeout_ms = 0;
+            }
+
             SDL_Event ev;
-            while (SDL_PollEvent(&ev)) {
-                if (ev.type == SDL_QUIT) {
-                    running = false;
-                } else if (ev.type == SDL_KEYDOWN) {
-                    last_input = std::chrono::steady_clock::now();
-                    switch (ev.key.keysym.sym) {
-                        case SDLK_ESCAPE:
-                            running = false;
-                            break;
-                        case SDLK_SPACE:
-                            if (current_view == ViewMode::Clock) {
-                                current_view = ViewMode::Calendar;
-                            } else if (current_view == ViewMode::Calendar) {
-                                current_view = ViewMode::Weather;
-                            } else {
-                                current_view = ViewMode::Clock;
-                            }
-                            break;
-                        case SDLK_s:
-                            capture_next_frame = true;
-                            break;
-                        case SDLK_LEFT:
-                            if (current_view == ViewMode::Calendar) {
-                                calendar_view.MoveSelectionDays(-1);
-                            }
-                            break;
-                        case SDLK_RIGHT:
-                            if (current_view == ViewMode::Calendar) {
-                                calendar_view.MoveSelectionDays(1);
-                            }
-                            break;
-                        case SDLK_UP:
-                            if (current_view == ViewMode::Calendar) {
-                                calendar_view.MoveSelectionDays(-7);
-                            }
-                            break;
-                        case SDLK_DOWN:
-                            if (current_view == ViewMode::Calendar) {
-                                calendar_view.MoveSelectionDays(7);
-                            }
-                            break;
-                        case SDLK_n:
-                            if (current_view == ViewMode::Calendar) {
-                                calendar_view.MoveMonth(1);
-                            }
-                            break;
-                        case SDLK_m:
-                            if (current_view == ViewMode::Calendar) {
-                                calendar_view.MoveMonth(-1);
-                            }
-                            break;
-                        case SDLK_t:
-                            if (current_view == ViewMode::Calendar) {
-                                calendar_view.JumpToToday();
-                            }
-                            break;
-                        default:
-                            break;
-                    }
+            bool woke = SDL_WaitEventTimeout(&ev, timeout_ms) != 0;
+            auto events_start = FrameProfiler::Clock::now();
+            loop_stats.OnWakeup(!woke);
+            if (woke) {
+                handle_event(ev);
+                while (SDL_PollEvent(&ev)) {
+                    handle_event(ev);
                 }
             }
+            double events_ms = std::chrono::duration<double, std::milli>(FrameProfiler::Clock::now() - events_start).count();
+            if (!running) {
+                break;
+            }
+            if (show_hud) {
+                needs_redraw = true;
+            }
 
             auto now = std::chrono::steady_clock::now();
             auto idle_sec = std::chrono::duration_cast<std::chrono::seconds>(now - last_input).count();
-            if (idle_sec >= config.idle_threshold_sec) {
+            if (idle_sec >= config.idle_threshold_sec && current_view != ViewMode::Clock) {
                 current_view = ViewMode::Clock;
+                needs_redraw = true;
+            }
+
+            // The back buffer is undefined after present, so a periodic
+            // snapshot needs a freshly rendered frame to read back.
+            if (snapshot_service.IsPeriodicDue(now)) {
+                capture_periodic = true;
+                needs_redraw = true;
+            }
+
+            int64_t now_ts = TimeUtil::NowTs();
+            int64_t minute = now_ts / 60;
+            if (minute != last_rendered_minute) {
+                needs_redraw = true;
+                prewarm_pending = true;
+            }
+            if (now_ts != last_rendered_ts && current_view == ViewMode::Clock && clock_view.TicksEverySecond()) {
+                needs_redraw = true;
+            }
+            if (night_mode.Update(now_ts)) {
+                compositor.SetDimLevel(night_mode.DimLevel());
+                needs_redraw = true;
             }
 
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-            SDL_RenderClear(renderer);
+            loop_stats.MaybeReport();
+            profiler.MaybeLogSummary();
+            if (!needs_redraw) {
+                // Idle: do the next view's SQL queries, text rasterisation and
+                // layer rendering now, so switching to it is a layer copy.
+                if (prewarm_pending) {
+                    prewarm_pending = false;
+                    int w = 0, h = 0;
+                    SDL_GetRendererOutputSize(renderer, &w, &h);
+                    LayeredView* next_view = view_for(next_view_mode(current_view));
+                    compositor.Prewarm(next_view, next_view->Prepare(w, h, now_ts), w, h);
+                }
+                continue;
+            }
+            frame_interval = std::chrono::milliseconds(
+                night_mode.IsNight() ? config.night_frame_interval_ms : config.day_frame_interval_ms);
+            if (std::chrono::steady_clock::now() - last_frame_time < frame_interval) {
+                continue;
+            }
+            last_frame_time = std::chrono::steady_clock::now();
+            needs_redraw = false;
+            last_rendered_minute = minute;
+            last_rendered_ts = now_ts;
+            loop_stats.OnFrame();
+            profiler.BeginFrame();
+            profiler.Record(FramePhase::Events, events_ms);
 
             int w = 0, h = 0;
             SDL_GetRendererOutputSize(renderer, &w, &h);
 
-            if (current_view == ViewMode::Clock) {
-                clock_view.Render(w, h);
-            } else if (current_view == ViewMode::Calendar) {
-                calendar_view.Render(w, h);
-            } else {
-                weather_view.Render(w, h);
+            LayeredView* active_view = view_for(current_view);
+            LayerChanges changes;
+            {
+                FrameProfiler::ScopedPhase phase(&profiler, FramePhase::Update);
+                changes = active_view->Prepare(w, h, now_ts);
+            }
+            {
+                FrameProfiler::ScopedPhase phase(&profiler, FramePhase::Render);
+                compositor.Draw(active_view, changes, w, h);
             }
 
-            if (config.night_mode_enabled) {
-                std::tm now_tm = TimeUtil::LocalTime(TimeUtil::NowTs());
-                int hour = now_tm.tm_hour;
-                bool is_night = false;
-                if (config.night_start_hour == config.night_end_hour) {
-                    is_night = false;
-                } else if (config.night_start_hour < config.night_end_hour) {
-                    is_night = (hour >= config.night_start_hour && hour < config.night_end_hour);
-                } else {
-                    is_night = (hour >= config.night_start_hour || hour < config.night_end_hour);
+            // Read back before the HUD is drawn and before present; encoding
+            // happens on the snapshot worker.
+            if (capture_next_frame || capture_periodic) {
+                profiler.BeginOverhead();
+                if (capture_next_frame) {
+                    snapshot_service.Capture(renderer, w, h, snapshot_service.Config().screenshot_path);
+                    capture_next_frame = false;
                 }
-
-                if (is_night && config.night_dim_alpha > 0) {
-                    int alpha = std::min(255, std::max(0, config.night_dim_alpha));
-                    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-                    SDL_SetRenderDrawColor(renderer, 0, 0, 0, static_cast<Uint8>(alpha));
-                    SDL_Rect dim_rect{ 0, 0, w, h };
-                    SDL_RenderFillRect(renderer, &dim_rect);
-                    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+                if (capture_periodic) {
+                    snapshot_service.Capture(renderer, w, h, snapshot_service.Config().snapshot_path);
+                    snapshot_service.MarkPeriodicTaken(std::chrono::steady_clock::now());
+                    capture_periodic = false;
                 }
+                profiler.EndOverhead();
             }
 
-            SDL_RenderPresent(renderer);
-
-            if (capture_next_frame) {
-                SDL_Surface* shot = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
-                if (shot) {
-                    if (SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, shot->pixels, shot->pitch) == 0) {
-                        SDL_SaveBMP(shot, "data/preview.bmp");
-                    } else {
-                        std::cerr << "SDL_RenderReadPixels failed: " << SDL_GetError() << "\n";
-                    }
-                    SDL_FreeSurface(shot);
-                } else {
-                    std::cerr << "SDL_CreateRGBSurfaceWithFormat failed: " << SDL_GetError() << "\n";
-                }
-                capture_next_frame = false;
+            if (show_hud) {
+                profiler.BeginOverhead();
+                std::vector<std::string> hud_lines = profiler.HudLines();
+                std::vector<std::string> font_lines = font_registry.MemoryReport();
+                hud_lines.insert(hud_lines.end(), font_lines.begin(), font_lines.end());
+                std::vector<std::string> text_lines = text_renderer.Cache().Report();
+                hud_lines.insert(hud_lines.end(), text_lines.begin(), text_lines.end());
+                debug_hud.Draw(hud_lines);
+                profiler.EndOverhead();
             }
 
-            SDL_Delay(33);
+            {
+                FrameProfiler::ScopedPhase phase(&profiler, FramePhase::Present);
+                SDL_RenderPresent(renderer);
+            }
+            profiler.EndFrame();
         }
     }
 
+    asset_loader.Stop();
+    snapshot_service.Stop();
     weather_service.Stop();
     sync_service.Stop();
 
-    TTF_CloseFont(font_time);
-    TTF_CloseFont(font_date);
-    TTF_CloseFont(font_info);
-    TTF_CloseFont(font_header);
-    TTF_CloseFont(font_day);
-    TTF_CloseFont(font_agenda);
-    TTF_CloseFont(font_weather_temp);
+    font_registry.CloseAll();
 
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
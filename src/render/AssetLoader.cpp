@@ -0,0 +1,66 @@
+#include "render/AssetLoader.h"
+
+#include <utility>
+
+AssetLoader::AssetLoader(std::function<void()> on_job_done, const AssetPack* pack)
+    : on_job_done_(std::move(on_job_done)), pack_(pack) {}
+
+AssetLoader::~AssetLoader() {
+    Stop();
+}
+
+void AssetLoader::Start() {
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    worker_ = std::thread(&AssetLoader::Run, this);
+}
+
+void AssetLoader::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+        jobs_.clear();
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool AssetLoader::IsRunning() const {
+    return running_;
+}
+
+bool AssetLoader::Submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return false;
+        }
+        jobs_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void AssetLoader::Run() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return !running_ || !jobs_.empty(); });
+            if (!running_) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        job();
+        if (on_job_done_) {
+            on_job_done_();
+        }
+    }
+}
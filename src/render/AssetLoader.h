@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class AssetPack;
+
+// Runs asset decoding (PNG inflate, pixel conversion, packing) on one
+// worker thread so it stays off the render thread. Jobs must not touch the
+// SDL renderer; they leave their result in state shared with the owner,
+// which uploads it on the render thread.
+class AssetLoader {
+public:
+    // `on_job_done` runs on the worker after each job, e.g. to wake the
+    // main loop so the result is picked up promptly. Jobs read assets from
+    // `pack` when it has them, from loose files otherwise.
+    explicit AssetLoader(std::function<void()> on_job_done = nullptr, const AssetPack* pack = nullptr);
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    void Start();
+    // Jobs not yet started are dropped.
+    void Stop();
+    bool IsRunning() const;
+    const AssetPack* Pack() const { return pack_; }
+
+    // Queues `job`; returns false without running it when not started.
+    bool Submit(std::function<void()> job);
+
+private:
+    void Run();
+
+    std::function<void()> on_job_done_;
+    const AssetPack* pack_;
+    std::atomic<bool> running_{false};
+    std::thread worker_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> jobs_;
+};
@@ -0,0 +1,141 @@
+#include "render/AssetPack.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+constexpr uint32_t kMaxImageEdge = 16384;
+
+std::string BaseName(const std::string& path) {
+    size_t end = path.find_last_not_of("/\\");
+    if (end == std::string::npos) {
+        return "";
+    }
+    size_t start = path.find_last_of("/\\", end);
+    start = start == std::string::npos ? 0 : start + 1;
+    return path.substr(start, end - start + 1);
+}
+
+} // namespace
+
+AssetPack::~AssetPack() {
+    Close();
+}
+
+bool AssetPack::Open(const std::string& path) {
+    using namespace AssetPackFormat;
+    Close();
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Failed to open asset pack " << path << "\n";
+        return false;
+    }
+    struct stat st {};
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(Header)) {
+        data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "Failed to map asset pack " << path << "\n";
+        return false;
+    }
+    data_ = data;
+    size_ = static_cast<size_t>(st.st_size);
+    path_ = path;
+
+    const auto* header = static_cast<const Header*>(data_);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion ||
+        header->byte_order != kByteOrderMark) {
+        std::cerr << "Asset pack " << path << " has an unknown format, version or byte order\n";
+        Close();
+        return false;
+    }
+    if (header->entry_count > (size_ - sizeof(Header)) / sizeof(Entry)) {
+        std::cerr << "Asset pack " << path << " is truncated\n";
+        Close();
+        return false;
+    }
+    entries_ = reinterpret_cast<const Entry*>(static_cast<const uint8_t*>(data_) + sizeof(Header));
+    entry_count_ = header->entry_count;
+
+    for (uint32_t i = 0; i < entry_count_; ++i) {
+        const Entry& entry = entries_[i];
+        bool ok = std::memchr(entry.name, '\0', kNameBytes) != nullptr && entry.offset % kAlignment == 0 &&
+                  entry.offset <= size_ && entry.size <= size_ - entry.offset;
+        if (ok && entry.kind == static_cast<uint32_t>(EntryKind::Image)) {
+            ok = entry.width > 0 && entry.height > 0 && entry.width <= kMaxImageEdge &&
+                 entry.height <= kMaxImageEdge && entry.pitch >= entry.width * 4 && entry.pitch % 4 == 0 &&
+                 entry.size >= static_cast<uint64_t>(entry.pitch) * entry.height;
+        }
+        if (!ok) {
+            std::cerr << "Asset pack " << path << " has a malformed entry " << i << "\n";
+            Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void AssetPack::Close() {
+    if (data_) {
+        munmap(data_, size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    entries_ = nullptr;
+    entry_count_ = 0;
+    path_.clear();
+}
+
+bool AssetPack::FindBlob(const std::string& name, Blob* out) const {
+    const AssetPackFormat::Entry* entry = Find(name, AssetPackFormat::EntryKind::Blob);
+    if (!entry) {
+        return false;
+    }
+    out->data = static_cast<const uint8_t*>(data_) + entry->offset;
+    out->size = static_cast<size_t>(entry->size);
+    return true;
+}
+
+bool AssetPack::FindImage(const std::string& name, Image* out) const {
+    const AssetPackFormat::Entry* entry = Find(name, AssetPackFormat::EntryKind::Image);
+    if (!entry) {
+        return false;
+    }
+    out->pixels = static_cast<const uint8_t*>(data_) + entry->offset;
+    out->w = static_cast<int>(entry->width);
+    out->h = static_cast<int>(entry->height);
+    out->pitch = static_cast<int>(entry->pitch);
+    return true;
+}
+
+std::string AssetPack::FontName(const std::string& path) {
+    return BaseName(path);
+}
+
+std::string AssetPack::CoverageName(const std::string& font_path) {
+    return "coverage/" + BaseName(font_path);
+}
+
+std::string AssetPack::SpriteName(const std::string& dir, const std::string& file) {
+    return BaseName(dir) + "/" + file;
+}
+
+const AssetPackFormat::Entry* AssetPack::Find(const std::string& name, AssetPackFormat::EntryKind kind) const {
+    // A pack holds a few dozen entries, looked up once each at startup.
+    for (uint32_t i = 0; i < entry_count_; ++i) {
+        const AssetPackFormat::Entry& entry = entries_[i];
+        if (entry.kind == static_cast<uint32_t>(kind) && name == entry.name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// On-disk layout of an asset pack, as written by rpi_calendar_pack:
+//   Header, then `entry_count` Entry records, then the data. Offsets are
+//   from the start of the file and 16-byte aligned. Images are ARGB8888 in
+//   the byte order of the machine that built the pack, straight (not
+//   premultiplied) alpha, rows `pitch` bytes apart.
+namespace AssetPackFormat {
+
+constexpr char kMagic[4] = { 'R', 'P', 'A', 'K' };
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrderMark = 0x01020304u;
+constexpr size_t kNameBytes = 64;
+constexpr size_t kAlignment = 16;
+
+enum class EntryKind : uint32_t {
+    Blob = 0,
+    Image = 1
+};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t entry_count;
+};
+
+struct Entry {
+    char name[kNameBytes];  // NUL-terminated
+    uint32_t kind;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint64_t offset;
+    uint64_t size;
+};
+
+static_assert(sizeof(Header) == 16, "Header layout is part of the file format");
+static_assert(sizeof(Entry) == 96, "Entry layout is part of the file format");
+
+} // namespace AssetPackFormat
+
+// Read-only view of an asset pack mapped into memory: the font bytes and
+// pre-decoded sprite pixels, so startup opens one file and inflates no PNG.
+// Everything returned points into the mapping and is valid until Close.
+class AssetPack {
+public:
+    struct Blob {
+        const void* data = nullptr;
+        size_t size = 0;
+    };
+
+    struct Image {
+        const void* pixels = nullptr;
+        int w = 0;
+        int h = 0;
+        int pitch = 0;
+    };
+
+    AssetPack() = default;
+    ~AssetPack();
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // Maps `path` and checks the header and every entry's bounds.
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return data_ != nullptr; }
+
+    bool FindBlob(const std::string& name, Blob* out) const;
+    bool FindImage(const std::string& name, Image* out) const;
+
+    // Entry names the packer gives and the loaders look up: a font by its
+    // file name, its glyph coverage bitmap as "coverage/<file name>", a
+    // sprite as "<directory name>/<file name>".
+    static std::string FontName(const std::string& path);
+    static std::string CoverageName(const std::string& font_path);
+    static std::string SpriteName(const std::string& dir, const std::string& file);
+
+    const std::string& Path() const { return path_; }
+    size_t Size() const { return size_; }
+
+private:
+    const AssetPackFormat::Entry* Find(const std::string& name, AssetPackFormat::EntryKind kind) const;
+
+    std::string path_;
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    const AssetPackFormat::Entry* entries_ = nullptr;
+    uint32_t entry_count_ = 0;
+};
@@ -0,0 +1,177 @@
+#include "render/Compositor.h"
+
+#include "util/PerfCounters.h"
+
+#include <iostream>
+
+namespace {
+
+SDL_Texture* CreateLayerTexture(SDL_Renderer* renderer, int width, int height) {
+    SDL_Texture* tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!tex) {
+        std::cerr << "SDL_CreateTexture (layer) failed: " << SDL_GetError() << "\n";
+        return nullptr;
+    }
+    PerfCounters::AddTextureCreated(0);
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_NONE);
+    return tex;
+}
+
+void ClearWhite(SDL_Renderer* renderer) {
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderClear(renderer);
+}
+
+} // namespace
+
+Compositor::Compositor(SDL_Renderer* renderer) : renderer_(renderer) {
+    supported_ = renderer_ && SDL_RenderTargetSupported(renderer_) == SDL_TRUE;
+    if (!supported_) {
+        std::cerr << "Render targets unsupported; drawing views directly.\n";
+    }
+}
+
+Compositor::~Compositor() {
+    for (auto& layers : layers_) {
+        DestroyTextures(&layers);
+    }
+}
+
+void Compositor::DestroyTextures(ViewLayers* layers) {
+    if (layers->static_layer) {
+        SDL_DestroyTexture(layers->static_layer);
+        layers->static_layer = nullptr;
+    }
+    if (layers->composed) {
+        SDL_DestroyTexture(layers->composed);
+        layers->composed = nullptr;
+    }
+    layers->static_valid = false;
+    layers->composed_valid = false;
+}
+
+void Compositor::InvalidateAll() {
+    for (auto& layers : layers_) {
+        layers.static_valid = false;
+        layers.composed_valid = false;
+    }
+}
+
+void Compositor::DestroyAll() {
+    for (auto& layers : layers_) {
+        DestroyTextures(&layers);
+    }
+}
+
+Compositor::ViewLayers* Compositor::LayersFor(const LayeredView* view, int width, int height) {
+    ViewLayers* layers = nullptr;
+    for (auto& item : layers_) {
+        if (item.view == view) {
+            layers = &item;
+            break;
+        }
+    }
+    if (!layers) {
+        layers_.push_back(ViewLayers{});
+        layers = &layers_.back();
+        layers->view = view;
+    }
+
+    if (layers->width != width || layers->height != height || !layers->static_layer || !layers->composed) {
+        DestroyTextures(layers);
+        layers->width = width;
+        layers->height = height;
+        layers->static_layer = CreateLayerTexture(renderer_, width, height);
+        layers->composed = CreateLayerTexture(renderer_, width, height);
+        if (!layers->static_layer || !layers->composed) {
+            DestroyTextures(layers);
+            return nullptr;
+        }
+    }
+    return layers;
+}
+
+bool Compositor::UpdateLayers(ViewLayers* layers, LayeredView* view, const LayerChanges& changes, int width, int height) {
+    if (layers->static_valid && layers->composed_valid && !changes.static_layer && !changes.dynamic_layer) {
+        return true;
+    }
+
+    SDL_Texture* previous_target = SDL_GetRenderTarget(renderer_);
+
+    if (!layers->static_valid || changes.static_layer) {
+        if (SDL_SetRenderTarget(renderer_, layers->static_layer) != 0) {
+            std::cerr << "SDL_SetRenderTarget failed: " << SDL_GetError() << "\n";
+            SDL_SetRenderTarget(renderer_, previous_target);
+            // The change is not drawn yet; a later frame without change
+            // flags must not reuse the old layers.
+            layers->static_valid = false;
+            layers->composed_valid = false;
+            return false;
+        }
+        ClearWhite(renderer_);
+        view->RenderStatic(width, height);
+        layers->static_valid = true;
+        layers->composed_valid = false;
+    }
+
+    if (!layers->composed_valid || changes.dynamic_layer) {
+        if (SDL_SetRenderTarget(renderer_, layers->composed) != 0) {
+            std::cerr << "SDL_SetRenderTarget failed: " << SDL_GetError() << "\n";
+            SDL_SetRenderTarget(renderer_, previous_target);
+            layers->composed_valid = false;
+            return false;
+        }
+        SDL_RenderCopy(renderer_, layers->static_layer, nullptr, nullptr);
+        PerfCounters::AddDrawCall();
+        view->RenderDynamic(width, height);
+        layers->composed_valid = true;
+    }
+
+    SDL_SetRenderTarget(renderer_, previous_target);
+    return true;
+}
+
+void Compositor::DrawDirect(LayeredView* view, int width, int height) {
+    ClearWhite(renderer_);
+    view->RenderStatic(width, height);
+    view->RenderDynamic(width, height);
+
+    // Without a cached frame to colour-mod, dim with a blended overlay.
+    if (dim_level_ < 255) {
+        SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer_, 0, 0, 0, static_cast<Uint8>(255 - dim_level_));
+        SDL_Rect dim_rect{ 0, 0, width, height };
+        SDL_RenderFillRect(renderer_, &dim_rect);
+        PerfCounters::AddDrawCall();
+        SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_NONE);
+    }
+}
+
+void Compositor::Draw(LayeredView* view, const LayerChanges& changes, int width, int height) {
+    if (!view || width <= 0 || height <= 0) {
+        return;
+    }
+    if (!supported_) {
+        DrawDirect(view, width, height);
+        return;
+    }
+
+    ViewLayers* layers = LayersFor(view, width, height);
+    if (!layers || !UpdateLayers(layers, view, changes, width, height)) {
+        DrawDirect(view, width, height);
+        return;
+    }
+    SDL_SetTextureColorMod(layers->composed, dim_level_, dim_level_, dim_level_);
+    SDL_RenderCopy(renderer_, layers->composed, nullptr, nullptr);
+    PerfCounters::AddDrawCall();
+}
+
+void Compositor::Prewarm(LayeredView* view, const LayerChanges& changes, int width, int height) {
+    if (!view || !supported_ || width <= 0 || height <= 0) {
+        return;
+    }
+    ViewLayers* layers = LayersFor(view, width, height);
+    if (layers) {
+        UpdateLayers(layers, view, changes, width, height);
+    }
+}
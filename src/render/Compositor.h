@@ -0,0 +1,61 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <vector>
+
+#include "render/LayeredView.h"
+
+// Renders each LayeredView into two cached render targets: the static layer,
+// and the composed frame (static layer + dynamic layer). A frame in which
+// neither layer changed is a single texture copy.
+class Compositor {
+public:
+    explicit Compositor(SDL_Renderer* renderer);
+    ~Compositor();
+
+    Compositor(const Compositor&) = delete;
+    Compositor& operator=(const Compositor&) = delete;
+
+    // Re-renders whichever layers `changes` (from view->Prepare) marks dirty
+    // and copies the composed frame to the current render target. Falls back
+    // to drawing the view directly when render targets are unavailable.
+    void Draw(LayeredView* view, const LayerChanges& changes, int width, int height);
+
+    // Brings the view's cached layers up to date without drawing anything to
+    // the current target, so a later Draw of an unchanged view is a copy.
+    void Prewarm(LayeredView* view, const LayerChanges& changes, int width, int height);
+
+    // Drops every cached layer, e.g. after SDL_RENDER_TARGETS_RESET.
+    void InvalidateAll();
+    // Destroys every cached layer texture, for SDL_RENDER_DEVICE_RESET;
+    // they are recreated on the next Draw or Prewarm.
+    void DestroyAll();
+
+    // Brightness applied when the composed frame is copied out (255 = none).
+    // Dimming is a colour-mod on that copy, not an extra full-screen blend.
+    void SetDimLevel(Uint8 level) { dim_level_ = level; }
+
+    bool UsesRenderTargets() const { return supported_; }
+
+private:
+    struct ViewLayers {
+        const LayeredView* view = nullptr;
+        SDL_Texture* static_layer = nullptr;
+        SDL_Texture* composed = nullptr;
+        int width = 0;
+        int height = 0;
+        bool static_valid = false;
+        bool composed_valid = false;
+    };
+
+    ViewLayers* LayersFor(const LayeredView* view, int width, int height);
+    bool UpdateLayers(ViewLayers* layers, LayeredView* view, const LayerChanges& changes, int width, int height);
+    void DrawDirect(LayeredView* view, int width, int height);
+    static void DestroyTextures(ViewLayers* layers);
+
+    SDL_Renderer* renderer_;
+    bool supported_ = false;
+    Uint8 dim_level_ = 255;
+    std::vector<ViewLayers> layers_;
+};
@@ -0,0 +1,82 @@
+#include "render/DebugHud.h"
+
+#include "util/PerfCounters.h"
+
+#include <algorithm>
+#include <iostream>
+
+DebugHud::DebugHud(SDL_Renderer* renderer, FontHandle font) : renderer_(renderer), font_(font) {}
+
+DebugHud::~DebugHud() {
+    Reset();
+}
+
+void DebugHud::Reset() {
+    for (auto& line : lines_) {
+        if (line.texture) {
+            SDL_DestroyTexture(line.texture);
+        }
+    }
+    lines_.clear();
+}
+
+void DebugHud::UpdateLine(Line& line, const std::string& text) {
+    if (line.texture && line.text == text) {
+        return;
+    }
+    if (line.texture) {
+        SDL_DestroyTexture(line.texture);
+        line.texture = nullptr;
+    }
+    line.text = text;
+    line.w = 0;
+    line.h = 0;
+    if (text.empty() || !font_.Get()) {
+        return;
+    }
+    SDL_Surface* surface = TTF_RenderUTF8_Blended(font_.Get(), text.c_str(), SDL_Color{ 255, 255, 255, 255 });
+    if (!surface) {
+        std::cerr << "TTF_RenderUTF8_Blended failed: " << TTF_GetError() << "\n";
+        return;
+    }
+    line.texture = SDL_CreateTextureFromSurface(renderer_, surface);
+    if (line.texture) {
+        PerfCounters::AddTextureCreated(static_cast<size_t>(surface->pitch) * surface->h);
+        line.w = surface->w;
+        line.h = surface->h;
+    }
+    SDL_FreeSurface(surface);
+}
+
+void DebugHud::Draw(const std::vector<std::string>& lines) {
+    if (lines_.size() < lines.size()) {
+        lines_.resize(lines.size());
+    }
+    int box_w = 0;
+    int box_h = 0;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        UpdateLine(lines_[i], lines[i]);
+        box_w = std::max(box_w, lines_[i].w);
+        box_h += lines_[i].h + 2;
+    }
+    if (box_w == 0) {
+        return;
+    }
+
+    const int pad = 8;
+    SDL_Rect box{ pad, pad, box_w + pad * 2, box_h + pad * 2 };
+    SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 190);
+    SDL_RenderFillRect(renderer_, &box);
+    SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_NONE);
+
+    int y = box.y + pad;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const Line& line = lines_[i];
+        if (line.texture) {
+            SDL_Rect dst{ box.x + pad, y, line.w, line.h };
+            SDL_RenderCopy(renderer_, line.texture, nullptr, &dst);
+        }
+        y += line.h + 2;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include <string>
+#include <vector>
+
+#include "render/FontRegistry.h"
+
+// Draws a small block of monospace-ish status lines in the top-left corner.
+// Line textures are kept until their text changes.
+class DebugHud {
+public:
+    DebugHud(SDL_Renderer* renderer, FontHandle font);
+    ~DebugHud();
+
+    DebugHud(const DebugHud&) = delete;
+    DebugHud& operator=(const DebugHud&) = delete;
+
+    void Draw(const std::vector<std::string>& lines);
+    // Drops the line textures, e.g. after SDL_RENDER_DEVICE_RESET.
+    void Reset();
+
+private:
+    struct Line {
+        std::string text;
+        SDL_Texture* texture = nullptr;
+        int w = 0;
+        int h = 0;
+    };
+
+    void UpdateLine(Line& line, const std::string& text);
+
+    SDL_Renderer* renderer_;
+    FontHandle font_;
+    std::vector<Line> lines_;
+};
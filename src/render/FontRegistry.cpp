@@ -0,0 +1,221 @@
+#include "render/FontRegistry.h"
+
+#include "render/AssetPack.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <locale>
+#include <sstream>
+
+TTF_Font* FontHandle::Get() const {
+    return registry_ ? registry_->Resolve(*this) : nullptr;
+}
+
+FontRegistry::~FontRegistry() {
+    CloseAll();
+}
+
+FontHandle FontRegistry::Register(const std::string& path, int size, int style) {
+    for (size_t i = 0; i < faces_.size(); ++i) {
+        const Face& face = faces_[i];
+        if (face.path == path && face.size == size && face.style == style) {
+            return FontHandle(this, i);
+        }
+    }
+    Face face;
+    face.path = path;
+    face.size = size;
+    face.style = style;
+    faces_.push_back(face);
+    return FontHandle(this, faces_.size() - 1);
+}
+
+TTF_Font* FontRegistry::Resolve(const FontHandle& handle) {
+    if (handle.registry_ != this || handle.id_ >= faces_.size()) {
+        return nullptr;
+    }
+    Face& face = faces_[handle.id_];
+    if (face.font || face.failed) {
+        return face.font;
+    }
+
+    // Prefer the asset pack, then a mapping of the font file. The RWops
+    // only wraps that memory; TTF_CloseFont frees the RWops, not the memory.
+    AssetPack::Blob blob;
+    if (!pack_ || !pack_->FindBlob(AssetPack::FontName(face.path), &blob)) {
+        if (const MappedFile* file = MapFile(face.path)) {
+            blob.data = file->data;
+            blob.size = file->size;
+        }
+    }
+    if (blob.data) {
+        SDL_RWops* rw = SDL_RWFromConstMem(blob.data, static_cast<int>(blob.size));
+        face.font = rw ? TTF_OpenFontRW(rw, 1, face.size) : nullptr;
+    } else {
+        face.font = TTF_OpenFont(face.path.c_str(), face.size);
+    }
+    if (!face.font) {
+        std::cerr << "Failed to load font " << face.path << " at " << face.size << "pt: " << TTF_GetError() << "\n";
+        face.failed = true;
+        return nullptr;
+    }
+    if (face.style != TTF_STYLE_NORMAL) {
+        TTF_SetFontStyle(face.font, face.style);
+    }
+    face.glyph_cache_bytes = EstimateGlyphCacheBytes(face.font);
+    if (!fallback_paths_.empty()) {
+        face.coverage = CoverageFor(face.path, face.font);
+    }
+    face_ids_[face.font] = handle.id_;
+    return face.font;
+}
+
+TTF_Font* FontRegistry::FaceFor(TTF_Font* font, uint32_t codepoint) {
+    if (fallback_paths_.empty()) {
+        return font;
+    }
+    auto it = face_ids_.find(font);
+    if (it == face_ids_.end()) {
+        return font;
+    }
+    size_t id = it->second;
+    if (!faces_[id].coverage || faces_[id].coverage->Has(codepoint)) {
+        return font;
+    }
+
+    if (!faces_[id].fallbacks_registered) {
+        // Register may grow faces_, so index rather than hold a reference.
+        std::vector<size_t> fallbacks;
+        for (const std::string& path : fallback_paths_) {
+            if (path != faces_[id].path) {
+                fallbacks.push_back(Register(path, faces_[id].size, faces_[id].style).id_);
+            }
+        }
+        faces_[id].fallbacks = std::move(fallbacks);
+        faces_[id].fallbacks_registered = true;
+    }
+    for (size_t fallback_id : faces_[id].fallbacks) {
+        TTF_Font* fallback = Resolve(FontHandle(this, fallback_id));
+        const GlyphCoverage* coverage = faces_[fallback_id].coverage;
+        if (fallback && coverage && coverage->Has(codepoint)) {
+            return fallback;
+        }
+    }
+    return font;
+}
+
+void FontRegistry::CloseAll() {
+    for (auto& face : faces_) {
+        if (face.font) {
+            TTF_CloseFont(face.font);
+            face.font = nullptr;
+        }
+        face.failed = false;
+        face.coverage = nullptr;
+    }
+    face_ids_.clear();
+    coverage_.clear();
+    for (auto& file : files_) {
+        if (file.data) {
+            munmap(file.data, file.size);
+            file.data = nullptr;
+        }
+    }
+    files_.clear();
+}
+
+std::vector<std::string> FontRegistry::MemoryReport() const {
+    std::vector<std::string> lines;
+    for (const auto& file : files_) {
+        if (!file.data) {
+            continue;
+        }
+        std::ostringstream out;
+        out.imbue(std::locale::classic());
+        out << "font map " << file.path.substr(file.path.find_last_of('/') + 1) << ": "
+            << std::fixed << std::setprecision(1) << (file.size / 1024.0) << " KB";
+        lines.push_back(out.str());
+    }
+    for (const auto& entry : coverage_) {
+        std::ostringstream out;
+        out.imbue(std::locale::classic());
+        out << "coverage " << entry.first.substr(entry.first.find_last_of('/') + 1) << ": "
+            << entry.second.Count() << " glyphs";
+        lines.push_back(out.str());
+    }
+    for (const auto& face : faces_) {
+        if (!face.font) {
+            continue;
+        }
+        std::ostringstream out;
+        out.imbue(std::locale::classic());
+        out << "face " << face.size << "pt";
+        if (face.style != TTF_STYLE_NORMAL) {
+            out << " style " << face.style;
+        }
+        out << ": glyph cache ~" << std::fixed << std::setprecision(1) << (face.glyph_cache_bytes / 1024.0) << " KB";
+        lines.push_back(out.str());
+    }
+    return lines;
+}
+
+const FontRegistry::MappedFile* FontRegistry::MapFile(const std::string& path) {
+    for (const auto& file : files_) {
+        if (file.path == path) {
+            return file.failed ? nullptr : &file;
+        }
+    }
+
+    MappedFile file;
+    file.path = path;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st {};
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            file.data = data;
+            file.size = static_cast<size_t>(st.st_size);
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (!file.data) {
+        std::cerr << "Failed to map font " << path << "; falling back to TTF_OpenFont.\n";
+        file.failed = true;
+    }
+    files_.push_back(file);
+    return file.failed ? nullptr : &files_.back();
+}
+
+const GlyphCoverage* FontRegistry::CoverageFor(const std::string& path, TTF_Font* font) {
+    auto it = coverage_.find(path);
+    if (it != coverage_.end()) {
+        return &it->second;
+    }
+    GlyphCoverage& coverage = coverage_[path];
+    AssetPack::Blob blob;
+    if (!pack_ || !pack_->FindBlob(AssetPack::CoverageName(path), &blob) || !coverage.Load(blob.data, blob.size)) {
+        coverage.Build(font);
+    }
+    return &coverage;
+}
+
+size_t FontRegistry::EstimateGlyphCacheBytes(TTF_Font* font) {
+    // SDL_ttf does not expose its glyph cache, so estimate it as the 8-bit
+    // coverage bitmaps of printable ASCII, which is what the views render.
+    size_t bytes = 0;
+    for (Uint16 ch = 32; ch < 127; ++ch) {
+        int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+        if (TTF_GlyphMetrics(font, ch, &minx, &maxx, &miny, &maxy, &advance) == 0) {
+            bytes += static_cast<size_t>(std::max(0, maxx - minx)) * static_cast<size_t>(std::max(0, maxy - miny));
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <SDL_ttf.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "render/GlyphCoverage.h"
+
+class AssetPack;
+class FontRegistry;
+
+// Cheap, copyable reference to a registered face. The face is opened on the
+// first Get(), so views that are never shown never open their fonts.
+class FontHandle {
+public:
+    FontHandle() = default;
+
+    TTF_Font* Get() const;
+    bool IsValid() const { return registry_ != nullptr; }
+
+private:
+    friend class FontRegistry;
+    FontHandle(FontRegistry* registry, size_t id) : registry_(registry), id_(id) {}
+
+    FontRegistry* registry_ = nullptr;
+    size_t id_ = 0;
+};
+
+// Owns every TTF_Font in the process. Requests for the same (path, size,
+// style) share one face, and all faces of a file read from one read-only
+// memory mapping instead of each re-reading the TTF from disk.
+class FontRegistry {
+public:
+    FontRegistry() = default;
+    ~FontRegistry();
+
+    FontRegistry(const FontRegistry&) = delete;
+    FontRegistry& operator=(const FontRegistry&) = delete;
+
+    // Faces whose file is in `pack` are opened from it instead of mapping
+    // the file. The pack must stay open until CloseAll.
+    void UsePack(const AssetPack* pack) { pack_ = pack; }
+
+    // Fonts tried, in order, for codepoints the requested face has no
+    // glyph for; each is opened at the size and style of the face it
+    // stands in for, on first use. Set before any face is resolved.
+    void SetFallbacks(const std::vector<std::string>& paths) { fallback_paths_ = paths; }
+
+    // Registers a face without touching the file.
+    FontHandle Register(const std::string& path, int size, int style = TTF_STYLE_NORMAL);
+
+    // Opens the face behind `handle` if needed; nullptr when it cannot be loaded.
+    TTF_Font* Resolve(const FontHandle& handle);
+
+    // The face to draw `codepoint` with: `font` when its file has a glyph
+    // for it, else the first fallback that does, else `font` (tofu). Only
+    // bit tests once the faces involved are open; `font` must come from
+    // Resolve.
+    TTF_Font* FaceFor(TTF_Font* font, uint32_t codepoint);
+
+    // Closes all faces and unmaps their files. Must run before TTF_Quit.
+    void CloseAll();
+
+    // One line per open face with its estimated glyph cache size, plus the
+    // mapped file sizes.
+    std::vector<std::string> MemoryReport() const;
+
+private:
+    struct MappedFile {
+        std::string path;
+        void* data = nullptr;
+        size_t size = 0;
+        bool failed = false;
+    };
+
+    struct Face {
+        std::string path;
+        int size = 0;
+        int style = TTF_STYLE_NORMAL;
+        TTF_Font* font = nullptr;
+        bool failed = false;
+        size_t glyph_cache_bytes = 0;
+        // Set while open when fallbacks are configured.
+        const GlyphCoverage* coverage = nullptr;
+        // Registered ids of the fallback faces; filled on first miss.
+        std::vector<size_t> fallbacks;
+        bool fallbacks_registered = false;
+    };
+
+    const MappedFile* MapFile(const std::string& path);
+    const GlyphCoverage* CoverageFor(const std::string& path, TTF_Font* font);
+    static size_t EstimateGlyphCacheBytes(TTF_Font* font);
+
+    std::vector<Face> faces_;
+    std::vector<MappedFile> files_;
+    const AssetPack* pack_ = nullptr;
+    std::vector<std::string> fallback_paths_;
+    // Per font file; node-based, so Face::coverage pointers stay valid.
+    std::unordered_map<std::string, GlyphCoverage> coverage_;
+    std::unordered_map<TTF_Font*, size_t> face_ids_;
+};
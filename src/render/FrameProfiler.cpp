@@ -0,0 +1,142 @@
+#include "render/FrameProfiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <locale>
+#include <sstream>
+
+namespace {
+
+const char* kPhaseLabels[] = { "events", "update", "render", "present" };
+
+std::string FormatBytes(uint64_t bytes) {
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+    if (bytes >= 1024 * 1024) {
+        out << std::fixed << std::setprecision(1) << (bytes / (1024.0 * 1024.0)) << " MB";
+    } else if (bytes >= 1024) {
+        out << std::fixed << std::setprecision(1) << (bytes / 1024.0) << " KB";
+    } else {
+        out << bytes << " B";
+    }
+    return out.str();
+}
+
+} // namespace
+
+RollingHistogram::RollingHistogram(size_t capacity) : samples_(std::max<size_t>(1, capacity), 0.0) {
+    scratch_.reserve(samples_.size());
+}
+
+void RollingHistogram::Add(double value) {
+    samples_[next_] = value;
+    next_ = (next_ + 1) % samples_.size();
+    count_ = std::min(count_ + 1, samples_.size());
+}
+
+double RollingHistogram::Percentile(double p) const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    scratch_.assign(samples_.begin(), samples_.begin() + static_cast<std::ptrdiff_t>(count_));
+    double clamped = std::min(1.0, std::max(0.0, p));
+    size_t index = static_cast<size_t>(clamped * static_cast<double>(count_ - 1) + 0.5);
+    std::nth_element(scratch_.begin(), scratch_.begin() + static_cast<std::ptrdiff_t>(index), scratch_.end());
+    return scratch_[index];
+}
+
+double RollingHistogram::Max() const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    return *std::max_element(samples_.begin(), samples_.begin() + static_cast<std::ptrdiff_t>(count_));
+}
+
+FrameProfiler::FrameProfiler() : last_log_(Clock::now()) {}
+
+void FrameProfiler::BeginFrame() {
+    current_.fill(0.0);
+    overhead_ = PerfCounters::Snapshot{};
+    frame_start_counters_ = PerfCounters::Read();
+}
+
+void FrameProfiler::Record(FramePhase phase, double ms) {
+    current_[static_cast<size_t>(phase)] += ms;
+}
+
+void FrameProfiler::EndFrame() {
+    double total = 0.0;
+    for (size_t i = 0; i < kPhaseCount; ++i) {
+        phases_[i].Add(current_[i]);
+        total += current_[i];
+    }
+    frame_total_.Add(total);
+
+    PerfCounters::Snapshot delta = PerfCounters::Delta(frame_start_counters_, PerfCounters::Read());
+    last_frame_counters_ = PerfCounters::Delta(overhead_, delta);
+    max_frame_counters_.sql_queries = std::max(max_frame_counters_.sql_queries, last_frame_counters_.sql_queries);
+    max_frame_counters_.textures_created = std::max(max_frame_counters_.textures_created, last_frame_counters_.textures_created);
+    max_frame_counters_.texture_bytes = std::max(max_frame_counters_.texture_bytes, last_frame_counters_.texture_bytes);
+    max_frame_counters_.draw_calls = std::max(max_frame_counters_.draw_calls, last_frame_counters_.draw_calls);
+    ++frames_;
+    ++frames_since_log_;
+}
+
+void FrameProfiler::BeginOverhead() {
+    overhead_start_counters_ = PerfCounters::Read();
+}
+
+void FrameProfiler::EndOverhead() {
+    PerfCounters::Snapshot delta = PerfCounters::Delta(overhead_start_counters_, PerfCounters::Read());
+    overhead_.sql_queries += delta.sql_queries;
+    overhead_.textures_created += delta.textures_created;
+    overhead_.texture_bytes += delta.texture_bytes;
+    overhead_.draw_calls += delta.draw_calls;
+}
+
+std::string FrameProfiler::FormatSummaryLine(const char* label, const RollingHistogram& hist) const {
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+    out << std::left << std::setw(8) << label << std::right << std::fixed << std::setprecision(2)
+        << " p50 " << hist.Percentile(0.50)
+        << "  p95 " << hist.Percentile(0.95)
+        << "  p99 " << hist.Percentile(0.99)
+        << "  max " << hist.Max() << " ms";
+    return out.str();
+}
+
+std::vector<std::string> FrameProfiler::HudLines() const {
+    std::vector<std::string> lines;
+    lines.push_back(FormatSummaryLine("frame", frame_total_));
+    for (size_t i = 0; i < kPhaseCount; ++i) {
+        lines.push_back(FormatSummaryLine(kPhaseLabels[i], phases_[i]));
+    }
+    lines.push_back("last frame: sql " + std::to_string(last_frame_counters_.sql_queries) +
+                    "  textures " + std::to_string(last_frame_counters_.textures_created) +
+                    "  upload " + FormatBytes(last_frame_counters_.texture_bytes) +
+                    "  draws " + std::to_string(last_frame_counters_.draw_calls));
+    lines.push_back("worst frame: sql " + std::to_string(max_frame_counters_.sql_queries) +
+                    "  textures " + std::to_string(max_frame_counters_.textures_created) +
+                    "  upload " + FormatBytes(max_frame_counters_.texture_bytes) +
+                    "  draws " + std::to_string(max_frame_counters_.draw_calls));
+    lines.push_back("frames " + std::to_string(frames_));
+    return lines;
+}
+
+void FrameProfiler::MaybeLogSummary() {
+    auto now = Clock::now();
+    if (std::chrono::duration_cast<std::chrono::seconds>(now - last_log_).count() < kLogIntervalSec) {
+        return;
+    }
+    last_log_ = now;
+    if (frames_since_log_ == 0) {
+        return;
+    }
+    std::cout << "Frame profile (" << frames_since_log_ << " frames since last summary):\n";
+    for (const auto& line : HudLines()) {
+        std::cout << "  " << line << "\n";
+    }
+    std::cout << std::flush;
+    frames_since_log_ = 0;
+}
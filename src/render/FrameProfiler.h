@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "util/PerfCounters.h"
+
+// Fixed-size ring of the most recent samples with percentile queries.
+class RollingHistogram {
+public:
+    explicit RollingHistogram(size_t capacity = 512);
+
+    void Add(double value);
+    size_t Count() const { return count_; }
+    double Percentile(double p) const;
+    double Max() const;
+
+private:
+    std::vector<double> samples_;
+    mutable std::vector<double> scratch_;
+    size_t next_ = 0;
+    size_t count_ = 0;
+};
+
+enum class FramePhase {
+    Events = 0,
+    Update = 1,
+    Render = 2,
+    Present = 3,
+    Count = 4
+};
+
+// Records where each rendered frame spends its time (event handling, view
+// cache updates, layer rendering, present) plus the SQL queries and texture
+// uploads the render thread issued, and summarises them for the debug HUD
+// and the log.
+class FrameProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class ScopedPhase {
+    public:
+        ScopedPhase(FrameProfiler* profiler, FramePhase phase)
+            : profiler_(profiler), phase_(phase), start_(Clock::now()) {}
+        ~ScopedPhase() {
+            profiler_->Record(phase_, std::chrono::duration<double, std::milli>(Clock::now() - start_).count());
+        }
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    private:
+        FrameProfiler* profiler_;
+        FramePhase phase_;
+        Clock::time_point start_;
+    };
+
+    FrameProfiler();
+
+    void BeginFrame();
+    void Record(FramePhase phase, double ms);
+    void EndFrame();
+
+    // Work bracketed by these calls (the HUD drawing itself) is excluded
+    // from the frame's cost counters.
+    void BeginOverhead();
+    void EndOverhead();
+
+    std::vector<std::string> HudLines() const;
+    void MaybeLogSummary();
+
+private:
+    static constexpr size_t kPhaseCount = static_cast<size_t>(FramePhase::Count);
+    static constexpr int64_t kLogIntervalSec = 600;
+
+    std::string FormatSummaryLine(const char* label, const RollingHistogram& hist) const;
+
+    std::array<RollingHistogram, kPhaseCount> phases_;
+    RollingHistogram frame_total_;
+    std::array<double, kPhaseCount> current_{};
+
+    PerfCounters::Snapshot frame_start_counters_;
+    PerfCounters::Snapshot overhead_start_counters_;
+    PerfCounters::Snapshot overhead_;
+    PerfCounters::Snapshot last_frame_counters_;
+    PerfCounters::Snapshot max_frame_counters_;
+
+    uint64_t frames_ = 0;
+    uint64_t frames_since_log_ = 0;
+    Clock::time_point last_log_;
+};
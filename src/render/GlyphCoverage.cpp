@@ -0,0 +1,45 @@
+#include "render/GlyphCoverage.h"
+
+#include <bitset>
+#include <cstring>
+
+namespace {
+
+bool GlyphProvided(TTF_Font* font, uint32_t codepoint) {
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+    return TTF_GlyphIsProvided32(font, codepoint) != 0;
+#else
+    return codepoint <= 0xFFFF && TTF_GlyphIsProvided(font, static_cast<Uint16>(codepoint)) != 0;
+#endif
+}
+
+} // namespace
+
+void GlyphCoverage::Build(TTF_Font* font) {
+    bits_.assign(kBytes / sizeof(uint64_t), 0);
+    if (!font) {
+        return;
+    }
+    for (uint32_t codepoint = 0; codepoint < kCodepointLimit; ++codepoint) {
+        if (GlyphProvided(font, codepoint)) {
+            bits_[codepoint >> 6] |= uint64_t{ 1 } << (codepoint & 63);
+        }
+    }
+}
+
+bool GlyphCoverage::Load(const void* data, size_t size) {
+    if (!data || size != kBytes) {
+        return false;
+    }
+    bits_.resize(kBytes / sizeof(uint64_t));
+    std::memcpy(bits_.data(), data, kBytes);
+    return true;
+}
+
+size_t GlyphCoverage::Count() const {
+    size_t count = 0;
+    for (uint64_t word : bits_) {
+        count += std::bitset<64>(word).count();
+    }
+    return count;
+}
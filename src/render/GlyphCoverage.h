@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SDL_ttf.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One bit per codepoint a font file has a glyph for, so picking a fallback
+// face per codepoint is a bit test instead of a FreeType lookup. Covers the
+// BMP and the symbol/emoji plane (U+0000..U+1FFFF); anything above counts
+// as missing. Coverage depends only on the file, not on size or style.
+class GlyphCoverage {
+public:
+    static constexpr uint32_t kCodepointLimit = 0x20000;
+    static constexpr size_t kBytes = kCodepointLimit / 8;
+
+    bool Has(uint32_t codepoint) const {
+        return codepoint < kCodepointLimit && !bits_.empty() &&
+               ((bits_[codepoint >> 6] >> (codepoint & 63)) & 1u) != 0;
+    }
+    bool Empty() const { return bits_.empty(); }
+
+    // Probes every codepoint in range through SDL_ttf; tens of milliseconds
+    // on a Pi, which is why the asset pack stores the result.
+    void Build(TTF_Font* font);
+    // Adopts a bitmap written by Data(); false if the size does not match.
+    bool Load(const void* data, size_t size);
+
+    // Raw bitmap, kBytes long once built, in native word order.
+    const void* Data() const { return bits_.data(); }
+    size_t ByteSize() const { return bits_.size() * sizeof(uint64_t); }
+    size_t Count() const;
+
+private:
+    std::vector<uint64_t> bits_;
+};
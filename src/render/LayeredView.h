@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+// Which cached layers of a view need to be re-rendered after Prepare().
+struct LayerChanges {
+    bool static_layer = false;
+    bool dynamic_layer = false;
+};
+
+// A view split into a static layer (panel borders, grid, headings) that only
+// depends on the output size, and a dynamic layer (time, agenda, forecast)
+// drawn on top of it. The Compositor caches both in render targets.
+class LayeredView {
+public:
+    virtual ~LayeredView() = default;
+
+    // Refreshes cached state for the given size and time and reports which
+    // layers changed since the previous call.
+    virtual LayerChanges Prepare(int width, int height, int64_t now_ts) = 0;
+    virtual void RenderStatic(int width, int height) = 0;
+    virtual void RenderDynamic(int width, int height) = 0;
+    // After SDL_RENDER_TARGETS_RESET the contents of render targets are
+    // gone; after SDL_RENDER_DEVICE_RESET (`device_lost`) every texture is.
+    // Views owning such textures redraw or recreate them here.
+    virtual void OnRenderReset(bool device_lost) { (void)device_lost; }
+};
@@ -0,0 +1,98 @@
+#include "render/PrimitiveBatch.h"
+
+#include "util/PerfCounters.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+#if !SDL_VERSION_ATLEAST(2, 0, 18)
+bool SameColor(SDL_Color a, SDL_Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+#endif
+
+} // namespace
+
+PrimitiveBatch::PrimitiveBatch(SDL_Renderer* renderer) : renderer_(renderer) {}
+
+void PrimitiveBatch::FillRect(const SDL_Rect& rect, SDL_Color color) {
+    if (rect.w <= 0 || rect.h <= 0) {
+        return;
+    }
+    rects_.push_back(rect);
+    colors_.push_back(color);
+}
+
+void PrimitiveBatch::DrawRect(const SDL_Rect& rect, SDL_Color color) {
+    if (rect.w <= 0 || rect.h <= 0) {
+        return;
+    }
+    FillRect(SDL_Rect{ rect.x, rect.y, rect.w, 1 }, color);
+    if (rect.h > 1) {
+        FillRect(SDL_Rect{ rect.x, rect.y + rect.h - 1, rect.w, 1 }, color);
+    }
+    FillRect(SDL_Rect{ rect.x, rect.y + 1, 1, rect.h - 2 }, color);
+    if (rect.w > 1) {
+        FillRect(SDL_Rect{ rect.x + rect.w - 1, rect.y + 1, 1, rect.h - 2 }, color);
+    }
+}
+
+void PrimitiveBatch::DrawLine(int x0, int y0, int x1, int y1, SDL_Color color) {
+    if (x0 == x1 || y0 == y1) {
+        FillRect(SDL_Rect{ std::min(x0, x1), std::min(y0, y1), std::abs(x1 - x0) + 1, std::abs(y1 - y0) + 1 }, color);
+        return;
+    }
+    Flush();
+    SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
+    SDL_RenderDrawLine(renderer_, x0, y0, x1, y1);
+    PerfCounters::AddDrawCall();
+}
+
+void PrimitiveBatch::Flush() {
+    if (rects_.empty()) {
+        return;
+    }
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    vertices_.clear();
+    indices_.clear();
+    for (size_t i = 0; i < rects_.size(); ++i) {
+        const SDL_Rect& r = rects_[i];
+        SDL_Color color = colors_[i];
+        float x0 = static_cast<float>(r.x);
+        float y0 = static_cast<float>(r.y);
+        float x1 = static_cast<float>(r.x + r.w);
+        float y1 = static_cast<float>(r.y + r.h);
+        int base = static_cast<int>(vertices_.size());
+        vertices_.push_back(SDL_Vertex{ SDL_FPoint{ x0, y0 }, color, SDL_FPoint{ 0.0f, 0.0f } });
+        vertices_.push_back(SDL_Vertex{ SDL_FPoint{ x1, y0 }, color, SDL_FPoint{ 0.0f, 0.0f } });
+        vertices_.push_back(SDL_Vertex{ SDL_FPoint{ x1, y1 }, color, SDL_FPoint{ 0.0f, 0.0f } });
+        vertices_.push_back(SDL_Vertex{ SDL_FPoint{ x0, y1 }, color, SDL_FPoint{ 0.0f, 0.0f } });
+        indices_.insert(indices_.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+    }
+    if (SDL_RenderGeometry(renderer_, nullptr, vertices_.data(), static_cast<int>(vertices_.size()),
+                           indices_.data(), static_cast<int>(indices_.size())) != 0) {
+        std::cerr << "SDL_RenderGeometry failed: " << SDL_GetError() << "\n";
+    }
+    PerfCounters::AddDrawCall();
+#else
+    // Without SDL_RenderGeometry: one fill call per run of equal colour,
+    // which keeps the queued order.
+    size_t begin = 0;
+    while (begin < rects_.size()) {
+        size_t end = begin + 1;
+        while (end < rects_.size() && SameColor(colors_[end], colors_[begin])) {
+            ++end;
+        }
+        SDL_Color color = colors_[begin];
+        SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
+        SDL_RenderFillRects(renderer_, &rects_[begin], static_cast<int>(end - begin));
+        PerfCounters::AddDrawCall();
+        begin = end;
+    }
+#endif
+    rects_.clear();
+    colors_.clear();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <vector>
+
+// Collects a layer's lines, rectangle outlines and fills and submits them
+// together. Axis-aligned lines and outlines become one-pixel fills, so a
+// whole batch is a single untextured SDL_RenderGeometry (one
+// SDL_RenderFillRects per run of equal colour before SDL 2.0.18), drawn in
+// the order it was queued. Buffers keep their capacity between flushes.
+class PrimitiveBatch {
+public:
+    explicit PrimitiveBatch(SDL_Renderer* renderer);
+
+    PrimitiveBatch(const PrimitiveBatch&) = delete;
+    PrimitiveBatch& operator=(const PrimitiveBatch&) = delete;
+
+    void FillRect(const SDL_Rect& rect, SDL_Color color);
+    // Same pixels as SDL_RenderDrawRect.
+    void DrawRect(const SDL_Rect& rect, SDL_Color color);
+    // Same pixels as SDL_RenderDrawLine, endpoints included. Diagonal lines
+    // cannot be expressed as fills; they flush the batch and are drawn on
+    // their own.
+    void DrawLine(int x0, int y0, int x1, int y1, SDL_Color color);
+
+    // Submits everything queued. Call before drawing anything that must
+    // appear on top (sprites, TextRenderer::Flush) and at the end of a layer.
+    void Flush();
+
+private:
+    SDL_Renderer* renderer_;
+    std::vector<SDL_Rect> rects_;
+    std::vector<SDL_Color> colors_;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    std::vector<SDL_Vertex> vertices_;
+    std::vector<int> indices_;
+#endif
+};
@@ -0,0 +1,415 @@
+#include "render/SpriteAtlas.h"
+
+#include "render/AssetLoader.h"
+#include "render/AssetPack.h"
+#include "util/PerfCounters.h"
+
+#include <SDL_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <utility>
+
+namespace {
+
+// Transparent gap between sprites so linear filtering of a scaled copy
+// never picks up a neighbour's edge.
+constexpr int kSpacing = 2;
+
+// Edge of the first pre-scaled sheet; it doubles when full, up to the
+// renderer's texture limit or kMaxScaledSheetSize.
+constexpr int kMinScaledSheetSize = 256;
+constexpr int kMaxScaledSheetSize = 4096;
+
+std::string JoinPath(const std::string& dir, const std::string& file) {
+    if (dir.empty()) {
+        return file;
+    }
+    char last = dir.back();
+    if (last == '/' || last == '\\') {
+        return dir + file;
+    }
+    return dir + "/" + file;
+}
+
+} // namespace
+
+SpriteAtlas::SpriteAtlas(SDL_Renderer* renderer) : renderer_(renderer) {}
+
+SpriteAtlas::~SpriteAtlas() {
+    Clear();
+}
+
+SpriteAtlas::PendingLoad::~PendingLoad() {
+    if (packed.sheet) {
+        SDL_FreeSurface(packed.sheet);
+    }
+}
+
+SpriteAtlas::Packed SpriteAtlas::Pack(const std::string& dir, const std::vector<std::string>& files,
+                                      const AssetPack* pack) {
+    Packed packed;
+    packed.rects.assign(files.size(), SDL_Rect{ 0, 0, 0, 0 });
+
+    std::vector<SDL_Surface*> surfaces(files.size(), nullptr);
+    int max_w = 0;
+    long long area = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        SDL_Surface* surface = nullptr;
+        AssetPack::Image image;
+        if (pack && pack->FindImage(AssetPack::SpriteName(dir, files[i]), &image)) {
+            // Wraps the mapping; nothing is decoded or copied until the blit.
+            surface = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<void*>(image.pixels), image.w, image.h, 32,
+                                                         image.pitch, SDL_PIXELFORMAT_ARGB8888);
+        } else {
+            std::string path = JoinPath(dir, files[i]);
+            SDL_Surface* loaded = IMG_Load(path.c_str());
+            if (!loaded) {
+                std::cerr << "Sprite load failed: " << path << " - " << IMG_GetError() << "\n";
+                continue;
+            }
+            // Blitting into the atlas must copy alpha as-is, so normalise the
+            // format first and disable blending on the source.
+            surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+            SDL_FreeSurface(loaded);
+        }
+        if (!surface) {
+            std::cerr << "Sprite convert failed: " << JoinPath(dir, files[i]) << " - " << SDL_GetError() << "\n";
+            continue;
+        }
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+        surfaces[i] = surface;
+        max_w = std::max(max_w, surface->w + kSpacing);
+        area += static_cast<long long>(surface->w + kSpacing) * (surface->h + kSpacing);
+    }
+
+    auto free_surfaces = [&surfaces]() {
+        for (SDL_Surface* surface : surfaces) {
+            if (surface) {
+                SDL_FreeSurface(surface);
+            }
+        }
+    };
+    if (area == 0) {
+        free_surfaces();
+        return packed;
+    }
+
+    // Shelf packing, tallest first, into a roughly square sheet.
+    std::vector<size_t> order(files.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&surfaces](size_t a, size_t b) {
+        int ha = surfaces[a] ? surfaces[a]->h : 0;
+        int hb = surfaces[b] ? surfaces[b]->h : 0;
+        return ha > hb;
+    });
+    int sheet_w = std::max(max_w, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(area)))));
+    int x = 0;
+    int y = 0;
+    int shelf_h = 0;
+    for (size_t i : order) {
+        SDL_Surface* surface = surfaces[i];
+        if (!surface) {
+            continue;
+        }
+        if (x + surface->w + kSpacing > sheet_w) {
+            x = 0;
+            y += shelf_h;
+            shelf_h = 0;
+        }
+        packed.rects[i] = SDL_Rect{ x, y, surface->w, surface->h };
+        x += surface->w + kSpacing;
+        shelf_h = std::max(shelf_h, surface->h + kSpacing);
+    }
+    int sheet_h = y + shelf_h;
+
+    packed.sheet = SDL_CreateRGBSurfaceWithFormat(0, sheet_w, sheet_h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!packed.sheet) {
+        std::cerr << "Sprite atlas surface failed: " << SDL_GetError() << "\n";
+        free_surfaces();
+        return packed;
+    }
+    for (size_t i = 0; i < surfaces.size(); ++i) {
+        if (surfaces[i]) {
+            SDL_Rect dst = packed.rects[i];
+            SDL_BlitSurface(surfaces[i], nullptr, packed.sheet, &dst);
+        }
+    }
+    free_surfaces();
+    return packed;
+}
+
+bool SpriteAtlas::Upload(Packed* packed) {
+    SDL_Surface* sheet = packed->sheet;
+    packed->sheet = nullptr;
+    sprites_.assign(packed->rects.size(), SDL_Rect{ 0, 0, 0, 0 });
+    if (!sheet) {
+        return false;
+    }
+
+    // Zeroed so a failed query reads as "no limit reported".
+    SDL_RendererInfo info{};
+    max_texture_size_ = kMaxScaledSheetSize;
+    if (SDL_GetRendererInfo(renderer_, &info) == 0) {
+        // Zero means no limit is reported.
+        if (info.max_texture_width > 0) {
+            max_texture_size_ = std::min(max_texture_size_, info.max_texture_width);
+        }
+        if (info.max_texture_height > 0) {
+            max_texture_size_ = std::min(max_texture_size_, info.max_texture_height);
+        }
+    }
+    if ((info.max_texture_width > 0 && sheet->w > info.max_texture_width) ||
+        (info.max_texture_height > 0 && sheet->h > info.max_texture_height)) {
+        std::cerr << "Sprite atlas " << sheet->w << "x" << sheet->h << " exceeds the renderer's texture limit\n";
+        SDL_FreeSurface(sheet);
+        return false;
+    }
+
+    texture_ = SDL_CreateTextureFromSurface(renderer_, sheet);
+    if (!texture_) {
+        std::cerr << "Sprite atlas texture failed: " << SDL_GetError() << "\n";
+        SDL_FreeSurface(sheet);
+        return false;
+    }
+    SDL_SetTextureBlendMode(texture_, SDL_BLENDMODE_BLEND);
+    PerfCounters::AddTextureCreated(static_cast<size_t>(sheet->pitch) * sheet->h);
+    sprites_ = std::move(packed->rects);
+    sheet_ = sheet;
+    return true;
+}
+
+bool SpriteAtlas::Load(const std::string& dir, const std::vector<std::string>& files, const AssetPack* pack) {
+    Clear();
+    Packed packed = Pack(dir, files, pack);
+    return Upload(&packed);
+}
+
+void SpriteAtlas::LoadAsync(AssetLoader* loader, const std::string& dir, const std::vector<std::string>& files) {
+    Clear();
+    auto pending = std::make_shared<PendingLoad>();
+    // The job owns its own reference, so it can finish safely after this
+    // atlas has been cleared or destroyed.
+    const AssetPack* pack = loader ? loader->Pack() : nullptr;
+    bool queued = loader && loader->Submit([pending, dir, files, pack]() {
+        pending->packed = Pack(dir, files, pack);
+        pending->done.store(true, std::memory_order_release);
+    });
+    if (!queued) {
+        Load(dir, files, pack);
+        return;
+    }
+    pending_ = std::move(pending);
+}
+
+bool SpriteAtlas::Poll() {
+    if (!pending_ || !pending_->done.load(std::memory_order_acquire)) {
+        return false;
+    }
+    std::shared_ptr<PendingLoad> pending = std::move(pending_);
+    return Upload(&pending->packed);
+}
+
+void SpriteAtlas::Clear() {
+    pending_.reset();
+    ClearScaled();
+    if (scaled_texture_) {
+        SDL_DestroyTexture(scaled_texture_);
+        scaled_texture_ = nullptr;
+        scaled_size_ = 0;
+    }
+    if (texture_) {
+        SDL_DestroyTexture(texture_);
+        texture_ = nullptr;
+    }
+    if (sheet_) {
+        SDL_FreeSurface(sheet_);
+        sheet_ = nullptr;
+    }
+    sprites_.clear();
+}
+
+void SpriteAtlas::RecreateTextures() {
+    ClearScaled();
+    if (scaled_texture_) {
+        SDL_DestroyTexture(scaled_texture_);
+        scaled_texture_ = nullptr;
+        scaled_size_ = 0;
+    }
+    if (texture_) {
+        SDL_DestroyTexture(texture_);
+        texture_ = nullptr;
+    }
+    if (!sheet_) {
+        return;
+    }
+    texture_ = SDL_CreateTextureFromSurface(renderer_, sheet_);
+    if (!texture_) {
+        std::cerr << "Sprite atlas texture failed: " << SDL_GetError() << "\n";
+        return;
+    }
+    SDL_SetTextureBlendMode(texture_, SDL_BLENDMODE_BLEND);
+    PerfCounters::AddTextureCreated(static_cast<size_t>(sheet_->pitch) * sheet_->h);
+}
+
+void SpriteAtlas::ClearScaled() {
+    // The texture is kept; new copies overwrite the old ones in place.
+    scaled_.clear();
+    shelf_x_ = 0;
+    shelf_y_ = 0;
+    shelf_h_ = 0;
+}
+
+bool SpriteAtlas::DrawFit(size_t index, const SDL_Rect& area) {
+    if (!texture_ || !Has(index)) {
+        return false;
+    }
+    const SDL_Rect& src = sprites_[index];
+    int max_w = std::max(1, area.w);
+    int max_h = std::max(1, area.h);
+    float scale = std::min(static_cast<float>(max_w) / src.w, static_cast<float>(max_h) / src.h);
+    int draw_w = std::max(1, static_cast<int>(std::round(src.w * scale)));
+    int draw_h = std::max(1, static_cast<int>(std::round(src.h * scale)));
+    SDL_Rect dst{
+        area.x + (area.w - draw_w) / 2,
+        area.y + (area.h - draw_h) / 2,
+        draw_w,
+        draw_h
+    };
+    if (const Scaled* scaled = FindScaled(index, draw_w, draw_h)) {
+        SDL_RenderCopy(renderer_, scaled_texture_, &scaled->rect, &dst);
+    } else {
+        SDL_RenderCopy(renderer_, texture_, &src, &dst);
+    }
+    PerfCounters::AddDrawCall();
+    return true;
+}
+
+const SpriteAtlas::Scaled* SpriteAtlas::FindScaled(size_t index, int w, int h) {
+    for (const Scaled& scaled : scaled_) {
+        if (scaled.index == index && scaled.w == w && scaled.h == h) {
+            return &scaled;
+        }
+    }
+    if (w == sprites_[index].w && h == sprites_[index].h) {
+        // Already 1:1 in the atlas.
+        return nullptr;
+    }
+
+    SDL_Rect rect;
+    if (!PlaceScaled(w, h, &rect)) {
+        // Too big for any sheet the renderer allows; let the GPU scale.
+        return nullptr;
+    }
+    Resample(sprites_[index], w, h);
+    SDL_UpdateTexture(scaled_texture_, &rect, scratch_.data(), w * 4);
+    PerfCounters::AddTextureUpload(scratch_.size() * 4);
+
+    Scaled scaled;
+    scaled.index = index;
+    scaled.w = w;
+    scaled.h = h;
+    scaled.rect = rect;
+    scaled_.push_back(scaled);
+    return &scaled_.back();
+}
+
+bool SpriteAtlas::PlaceScaled(int w, int h, SDL_Rect* out) {
+    int need = std::max(w, h) + kSpacing;
+    int size = std::max(scaled_size_, kMinScaledSheetSize);
+    while (size < need && size < max_texture_size_) {
+        size *= 2;
+    }
+    size = std::min(size, max_texture_size_);
+    if (need > size) {
+        return false;
+    }
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (scaled_texture_ && size == scaled_size_) {
+            if (shelf_x_ + w + kSpacing > scaled_size_) {
+                shelf_x_ = 0;
+                shelf_y_ += shelf_h_;
+                shelf_h_ = 0;
+            }
+            if (shelf_y_ + h + kSpacing <= scaled_size_) {
+                *out = SDL_Rect{ shelf_x_, shelf_y_, w, h };
+                shelf_x_ += w + kSpacing;
+                shelf_h_ = std::max(shelf_h_, h + kSpacing);
+                return true;
+            }
+            // Full: start a sheet twice the size, copies are made again on
+            // demand.
+            if (scaled_size_ * 2 > max_texture_size_) {
+                return false;
+            }
+            size = scaled_size_ * 2;
+        }
+        if (scaled_texture_) {
+            SDL_DestroyTexture(scaled_texture_);
+        }
+        ClearScaled();
+        scaled_texture_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, size, size);
+        if (!scaled_texture_) {
+            std::cerr << "SDL_CreateTexture (scaled sprites) failed: " << SDL_GetError() << "\n";
+            scaled_size_ = 0;
+            return false;
+        }
+        SDL_SetTextureBlendMode(scaled_texture_, SDL_BLENDMODE_BLEND);
+        PerfCounters::AddTextureCreated(static_cast<size_t>(size) * size * 4);
+        scaled_size_ = size;
+    }
+    return false;
+}
+
+void SpriteAtlas::Resample(const SDL_Rect& src, int w, int h) {
+    // Area averaging: each output pixel is the coverage-weighted mean of
+    // the source pixels under it, computed on premultiplied colour so
+    // transparent edges do not darken. This is a proper box filter when
+    // shrinking and keeps hard pixel edges (softened by one pixel) when
+    // growing.
+    scratch_.assign(static_cast<size_t>(w) * h, 0);
+    const uint8_t* pixels = static_cast<const uint8_t*>(sheet_->pixels);
+    double step_x = static_cast<double>(src.w) / w;
+    double step_y = static_cast<double>(src.h) / h;
+    for (int dy = 0; dy < h; ++dy) {
+        double y0 = dy * step_y;
+        double y1 = y0 + step_y;
+        int iy_end = std::min(src.h, static_cast<int>(std::ceil(y1)));
+        for (int dx = 0; dx < w; ++dx) {
+            double x0 = dx * step_x;
+            double x1 = x0 + step_x;
+            int ix_end = std::min(src.w, static_cast<int>(std::ceil(x1)));
+            double a = 0.0;
+            double r = 0.0;
+            double g = 0.0;
+            double b = 0.0;
+            double total = 0.0;
+            for (int iy = static_cast<int>(y0); iy < iy_end; ++iy) {
+                double wy = std::min(y1, iy + 1.0) - std::max(y0, static_cast<double>(iy));
+                const uint32_t* row = reinterpret_cast<const uint32_t*>(pixels + (src.y + iy) * sheet_->pitch);
+                for (int ix = static_cast<int>(x0); ix < ix_end; ++ix) {
+                    double weight = wy * (std::min(x1, ix + 1.0) - std::max(x0, static_cast<double>(ix)));
+                    uint32_t p = row[src.x + ix];
+                    double pa = static_cast<double>(p >> 24);
+                    double wa = weight * pa;
+                    a += wa;
+                    r += wa * ((p >> 16) & 0xFF);
+                    g += wa * ((p >> 8) & 0xFF);
+                    b += wa * (p & 0xFF);
+                    total += weight;
+                }
+            }
+            if (a <= 0.0 || total <= 0.0) {
+                continue;
+            }
+            auto channel = [](double value) {
+                return static_cast<uint32_t>(std::min(255.0, std::max(0.0, std::round(value))));
+            };
+            scratch_[static_cast<size_t>(dy) * w + dx] = (channel(a / total) << 24) | (channel(r / a) << 16) |
+                                                        (channel(g / a) << 8) | channel(b / a);
+        }
+    }
+}
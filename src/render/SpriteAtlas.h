@@ -0,0 +1,99 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class AssetLoader;
+class AssetPack;
+
+// A fixed set of PNG sprites packed into one texture when loaded. Sprites
+// are addressed by their position in the list passed to Load, so callers
+// index with their own enum and a draw is a sub-rect copy, no lookup.
+//
+// Draws are served from a second sheet of copies resampled on the CPU to
+// the exact size asked for, so the GPU copies them 1:1 instead of
+// minifying the full-size PNG every frame. Copies are made on first use
+// and kept until ClearScaled, which views call when their size changes.
+class SpriteAtlas {
+public:
+    explicit SpriteAtlas(SDL_Renderer* renderer);
+    ~SpriteAtlas();
+
+    SpriteAtlas(const SpriteAtlas&) = delete;
+    SpriteAtlas& operator=(const SpriteAtlas&) = delete;
+
+    // Loads `dir`/`files[i]` as sprite i, taking pre-decoded pixels from
+    // `pack` when it has them. Missing files are reported and left empty;
+    // returns false only if nothing could be loaded.
+    bool Load(const std::string& dir, const std::vector<std::string>& files, const AssetPack* pack = nullptr);
+    // Same, but decodes and packs on `loader`'s thread, with its pack; the
+    // texture is made by the first Poll after that finishes. Until then
+    // draws fail, so views show their fallbacks. Loads synchronously if
+    // `loader` is not running.
+    void LoadAsync(AssetLoader* loader, const std::string& dir, const std::vector<std::string>& files);
+    // Uploads a finished LoadAsync; true on the call that made the sprites
+    // available, so the caller can redraw.
+    bool Poll();
+    void Clear();
+    // Drops the pre-scaled copies; they are rebuilt as they are drawn.
+    void ClearScaled();
+    // After SDL_RENDER_DEVICE_RESET: uploads the atlas again from the kept
+    // sheet and drops the scaled copies, whose texture was lost with it.
+    void RecreateTextures();
+
+    bool Loaded() const { return texture_ != nullptr; }
+    bool Has(size_t index) const { return index < sprites_.size() && sprites_[index].w > 0; }
+
+    // Copies sprite `index` scaled to fit `area` with its aspect kept,
+    // centred. Returns false if the sprite is missing.
+    bool DrawFit(size_t index, const SDL_Rect& area);
+
+private:
+    struct Scaled {
+        size_t index = 0;
+        int w = 0;
+        int h = 0;
+        SDL_Rect rect{ 0, 0, 0, 0 };
+    };
+
+    // Decoded and packed pixels, built without touching the renderer.
+    struct Packed {
+        SDL_Surface* sheet = nullptr;
+        std::vector<SDL_Rect> rects;
+    };
+
+    struct PendingLoad {
+        ~PendingLoad();
+        std::atomic<bool> done{ false };
+        Packed packed;
+    };
+
+    static Packed Pack(const std::string& dir, const std::vector<std::string>& files, const AssetPack* pack);
+    bool Upload(Packed* packed);
+    const Scaled* FindScaled(size_t index, int w, int h);
+    bool PlaceScaled(int w, int h, SDL_Rect* out);
+    void Resample(const SDL_Rect& src, int w, int h);
+
+    SDL_Renderer* renderer_;
+    SDL_Texture* texture_ = nullptr;
+    // Source rect in the atlas; zero-sized for sprites that failed to load.
+    std::vector<SDL_Rect> sprites_;
+    // The packed source pixels, kept for resampling.
+    SDL_Surface* sheet_ = nullptr;
+    int max_texture_size_ = 0;
+    std::shared_ptr<PendingLoad> pending_;
+
+    SDL_Texture* scaled_texture_ = nullptr;
+    int scaled_size_ = 0;
+    int shelf_x_ = 0;
+    int shelf_y_ = 0;
+    int shelf_h_ = 0;
+    std::vector<Scaled> scaled_;
+    std::vector<uint32_t> scratch_;
+};
@@ -0,0 +1,124 @@
+#include "render/TextCache.h"
+
+#include <iomanip>
+#include <locale>
+#include <sstream>
+
+TextCache::TextCache(TextRenderer* renderer, size_t budget_bytes) : renderer_(renderer), budget_bytes_(budget_bytes) {}
+
+void TextCache::Update(CachedText* cache, TTF_Font* font, const std::string& text, SDL_Color color, bool pin) {
+    cache->color = color;
+    if (text.empty() || !font) {
+        cache->Clear();
+        return;
+    }
+    // A handle first filled unpinned goes through Acquire once more so the
+    // entry is pinned before eviction can reach it.
+    if (cache->layout && cache->text == text && cache->layout->font == font &&
+        cache->layout->generation == renderer_->Generation() && (cache->pinned || !pin)) {
+        return;
+    }
+    cache->text = text;
+    cache->layout = Acquire(font, text, pin);
+    cache->pinned = pin;
+    cache->w = cache->layout->w;
+    cache->h = cache->layout->h;
+}
+
+std::shared_ptr<const TextLayout> TextCache::Acquire(TTF_Font* font, const std::string& text, bool pin) {
+    Key key{ font, text };
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        Entry& entry = *it->second;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        if (pin && !entry.pinned) {
+            entry.pinned = true;
+            stats_.bytes -= entry.bytes;
+            ++stats_.pinned;
+        }
+        if (entry.layout->generation != renderer_->Generation()) {
+            // The atlas was cleared since: lay out again into a new object,
+            // views still drawing the old one keep a valid (if slower) copy.
+            auto layout = std::make_shared<TextLayout>();
+            renderer_->Layout(font, text, layout.get());
+            entry.layout = std::move(layout);
+            if (!entry.pinned) {
+                stats_.bytes -= entry.bytes;
+                entry.bytes = EstimateBytes(entry);
+                stats_.bytes += entry.bytes;
+            }
+        }
+        ++stats_.hits;
+        return entry.layout;
+    }
+
+    ++stats_.misses;
+    Entry entry;
+    entry.key = key;
+    entry.layout = std::make_shared<TextLayout>();
+    entry.pinned = pin;
+    renderer_->Layout(font, text, entry.layout.get());
+    entry.bytes = EstimateBytes(entry);
+    if (pin) {
+        ++stats_.pinned;
+    } else {
+        stats_.bytes += entry.bytes;
+    }
+    lru_.push_front(std::move(entry));
+    index_.emplace(std::move(key), lru_.begin());
+    std::shared_ptr<const TextLayout> layout = lru_.front().layout;
+    EvictToBudget();
+    return layout;
+}
+
+void TextCache::SetBudget(size_t budget_bytes) {
+    budget_bytes_ = budget_bytes;
+    EvictToBudget();
+}
+
+void TextCache::Clear() {
+    index_.clear();
+    lru_.clear();
+    stats_.bytes = 0;
+    stats_.pinned = 0;
+}
+
+TextCache::Stats TextCache::GetStats() const {
+    Stats stats = stats_;
+    stats.entries = lru_.size();
+    stats.budget_bytes = budget_bytes_;
+    return stats;
+}
+
+std::vector<std::string> TextCache::Report() const {
+    Stats stats = GetStats();
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+    out << "text cache: " << stats.entries << " (" << stats.pinned << " pinned) "
+        << std::fixed << std::setprecision(1) << (stats.bytes / 1024.0) << "/" << (stats.budget_bytes / 1024.0)
+        << " KB, hit " << stats.hits << " miss " << stats.misses << " evict " << stats.evictions;
+    std::ostringstream atlas;
+    atlas.imbue(std::locale::classic());
+    atlas << "glyph atlas: " << (renderer_->AtlasBytes() / 1024) << " KB";
+    return { out.str(), atlas.str() };
+}
+
+size_t TextCache::EstimateBytes(const Entry& entry) {
+    // Key stored twice (list and index), plus node and glyph storage.
+    return sizeof(Entry) + sizeof(TextLayout) + 2 * entry.key.text.capacity() +
+           entry.layout->glyphs.capacity() * sizeof(TextLayout::Glyph) + 64;
+}
+
+void TextCache::EvictToBudget() {
+    auto it = lru_.end();
+    while (stats_.bytes > budget_bytes_ && it != lru_.begin()) {
+        --it;
+        if (it->pinned) {
+            continue;
+        }
+        stats_.bytes -= it->bytes;
+        ++stats_.evictions;
+        index_.erase(it->key);
+        it = lru_.erase(it);
+    }
+}
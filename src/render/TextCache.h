@@ -0,0 +1,105 @@
+#pragma once
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "render/TextRenderer.h"
+
+// A view's handle on one string: what it last asked for, plus the shared
+// layout. The layout stays valid while held even if the cache evicts it.
+struct CachedText {
+    std::string text;
+    std::shared_ptr<const TextLayout> layout;
+    int w = 0;
+    int h = 0;
+    SDL_Color color{ 0, 0, 0, 0 };
+    // Whether `layout` was acquired pinned.
+    bool pinned = false;
+
+    bool Empty() const { return !layout || layout->Empty(); }
+    void Clear() {
+        text.clear();
+        layout.reset();
+        w = 0;
+        h = 0;
+        pinned = false;
+    }
+};
+
+// Text layouts shared by every view, keyed by (font, text); colour is
+// applied at draw time and is not part of the key. Entries are evicted
+// least recently used first once their estimated size exceeds the budget.
+// Pinned entries (fixed headings) are never evicted and do not count
+// against it.
+class TextCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t pinned = 0;
+        size_t bytes = 0;
+        size_t budget_bytes = 0;
+    };
+
+    TextCache(TextRenderer* renderer, size_t budget_bytes);
+
+    TextCache(const TextCache&) = delete;
+    TextCache& operator=(const TextCache&) = delete;
+
+    // Points `cache` at the layout of `text` in `font`. Cheap when the
+    // handle already holds it (pinned, if `pin` asks for that); an empty
+    // `text` clears the handle.
+    void Update(CachedText* cache, TTF_Font* font, const std::string& text, SDL_Color color, bool pin = false);
+
+    std::shared_ptr<const TextLayout> Acquire(TTF_Font* font, const std::string& text, bool pin = false);
+
+    void SetBudget(size_t budget_bytes);
+    void Clear();
+
+    Stats GetStats() const;
+    std::vector<std::string> Report() const;
+
+private:
+    struct Key {
+        TTF_Font* font;
+        std::string text;
+        bool operator==(const Key& other) const { return font == other.font && text == other.text; }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            size_t h = std::hash<std::string>()(key.text);
+            return h ^ (std::hash<const void*>()(key.font) + 0x9E3779B9u + (h << 6) + (h >> 2));
+        }
+    };
+
+    struct Entry {
+        Key key;
+        std::shared_ptr<TextLayout> layout;
+        size_t bytes = 0;
+        bool pinned = false;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    static size_t EstimateBytes(const Entry& entry);
+    void EvictToBudget();
+
+    TextRenderer* renderer_;
+    size_t budget_bytes_;
+    // Most recently used first.
+    EntryList lru_;
+    std::unordered_map<Key, EntryList::iterator, KeyHash> index_;
+    Stats stats_;
+};
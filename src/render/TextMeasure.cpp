@@ -0,0 +1,153 @@
+#include "render/TextMeasure.h"
+
+#include "render/FontRegistry.h"
+#include "util/Utf8.h"
+
+#include <algorithm>
+
+namespace {
+
+const char kEllipsis[] = "...";
+
+int GlyphAdvance(TTF_Font* font, uint32_t codepoint) {
+    int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+    if (TTF_GlyphMetrics32(font, codepoint, &minx, &maxx, &miny, &maxy, &advance) == 0) {
+        return advance;
+    }
+#else
+    if (codepoint <= 0xFFFF &&
+        TTF_GlyphMetrics(font, static_cast<Uint16>(codepoint), &minx, &maxx, &miny, &maxy, &advance) == 0) {
+        return advance;
+    }
+#endif
+    return 0;
+}
+
+} // namespace
+
+int TextMeasure::Kerning(TTF_Font* font, uint32_t previous, uint32_t codepoint) {
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+    return TTF_GetFontKerningSizeGlyphs32(font, previous, codepoint);
+#else
+    if (previous > 0xFFFF || codepoint > 0xFFFF) {
+        return 0;
+    }
+    return TTF_GetFontKerningSizeGlyphs(font, static_cast<Uint16>(previous), static_cast<Uint16>(codepoint));
+#endif
+}
+
+int TextMeasure::Advance(TTF_Font* font, uint32_t codepoint) {
+    FontAdvances& advances = advances_[font];
+    if (codepoint < advances.ascii.size()) {
+        int& cached = advances.ascii[codepoint];
+        if (cached < 0) {
+            cached = GlyphAdvance(FaceFor(font, codepoint), codepoint);
+        }
+        return cached;
+    }
+    auto it = advances.other.find(codepoint);
+    if (it == advances.other.end()) {
+        it = advances.other.emplace(codepoint, GlyphAdvance(FaceFor(font, codepoint), codepoint)).first;
+    }
+    return it->second;
+}
+
+int TextMeasure::Width(TTF_Font* font, const std::string& text) {
+    if (!font) {
+        return 0;
+    }
+    // Kerned like TextRenderer::Layout: only within a run of one face.
+    int width = 0;
+    uint32_t previous = 0;
+    TTF_Font* previous_face = nullptr;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        uint32_t codepoint = Utf8::DecodeNext(text, &pos);
+        TTF_Font* face = FaceFor(font, codepoint);
+        if (previous != 0 && face == previous_face) {
+            width += Kerning(face, previous, codepoint);
+        }
+        width += Advance(font, codepoint);
+        previous = codepoint;
+        previous_face = face;
+    }
+    return width;
+}
+
+std::string TextMeasure::Truncate(TTF_Font* font, const std::string& text, int max_width) {
+    TruncateKey key{ font, max_width, text };
+    auto it = truncated_.find(key);
+    if (it != truncated_.end()) {
+        return it->second;
+    }
+    if (truncated_.size() >= kMaxTruncateEntries) {
+        truncated_.clear();
+    }
+    std::string result = TruncateUncached(font, text, max_width);
+    return truncated_.emplace(std::move(key), std::move(result)).first->second;
+}
+
+TTF_Font* TextMeasure::FaceFor(TTF_Font* font, uint32_t codepoint) {
+    return fonts_ ? fonts_->FaceFor(font, codepoint) : font;
+}
+
+void TextMeasure::Clear() {
+    advances_.clear();
+    truncated_.clear();
+}
+
+std::string TextMeasure::TruncateUncached(TTF_Font* font, const std::string& text, int max_width) {
+    if (!font) {
+        return text;
+    }
+
+    // prefix_[i] is the pen position after the first i codepoints and
+    // offsets_[i] the byte offset where codepoint i starts, so every
+    // candidate cut is a codepoint boundary.
+    codepoints_.clear();
+    faces_.clear();
+    offsets_.clear();
+    prefix_.clear();
+    offsets_.push_back(0);
+    prefix_.push_back(0);
+    int pen = 0;
+    uint32_t previous = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        uint32_t codepoint = Utf8::DecodeNext(text, &pos);
+        TTF_Font* face = FaceFor(font, codepoint);
+        if (previous != 0 && face == faces_.back()) {
+            pen += Kerning(face, previous, codepoint);
+        }
+        pen += Advance(font, codepoint);
+        previous = codepoint;
+        codepoints_.push_back(codepoint);
+        faces_.push_back(face);
+        offsets_.push_back(pos);
+        prefix_.push_back(pen);
+    }
+    if (pen <= max_width) {
+        return text;
+    }
+
+    int ellipsis_w = Width(font, kEllipsis);
+    TTF_Font* dot_face = FaceFor(font, '.');
+    auto fits = [&](size_t count) {
+        int kern = (count > 0 && faces_[count - 1] == dot_face) ? Kerning(dot_face, codepoints_[count - 1], '.') : 0;
+        return prefix_[count] + kern + ellipsis_w <= max_width;
+    };
+    // Advances are non-negative, so the prefix width only grows; find the
+    // longest prefix that still fits next to the ellipsis.
+    size_t lo = 0;
+    size_t hi = codepoints_.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo + 1) / 2;
+        if (fits(mid)) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return text.substr(0, offsets_[lo]) + kEllipsis;
+}
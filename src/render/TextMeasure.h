@@ -0,0 +1,86 @@
+#pragma once
+
+#include <SDL_ttf.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class FontRegistry;
+
+// Text widths from cached per-glyph advances plus kerning, without asking
+// SDL_ttf to lay out the whole string each time. Widths are pen advances,
+// which is what the views budget their columns with.
+class TextMeasure {
+public:
+    TextMeasure() = default;
+
+    TextMeasure(const TextMeasure&) = delete;
+    TextMeasure& operator=(const TextMeasure&) = delete;
+
+    // Measures codepoints `font` lacks with the fallback face `fonts` would
+    // draw them with. Call before measuring anything.
+    void UseFonts(FontRegistry* fonts) { fonts_ = fonts; }
+
+    int Advance(TTF_Font* font, uint32_t codepoint);
+    int Width(TTF_Font* font, const std::string& text);
+
+    // Returns `text` if it fits in `max_width`, otherwise the longest prefix
+    // (cut on a codepoint boundary) that fits with "..." appended, or just
+    // "..." when nothing does. Results are memoized per (font, width, text);
+    // the memo is dropped wholesale when full, so a copy is returned.
+    std::string Truncate(TTF_Font* font, const std::string& text, int max_width);
+
+    // Forgets every font, e.g. after the faces were closed and reopened.
+    void Clear();
+
+    static int Kerning(TTF_Font* font, uint32_t previous, uint32_t codepoint);
+
+private:
+    struct FontAdvances {
+        // Printable ASCII is looked up directly; -1 means not measured yet.
+        std::array<int, 128> ascii;
+        std::unordered_map<uint32_t, int> other;
+
+        FontAdvances() { ascii.fill(-1); }
+    };
+
+    struct TruncateKey {
+        TTF_Font* font;
+        int max_width;
+        std::string text;
+        bool operator==(const TruncateKey& other) const {
+            return font == other.font && max_width == other.max_width && text == other.text;
+        }
+    };
+
+    struct TruncateKeyHash {
+        size_t operator()(const TruncateKey& key) const {
+            size_t h = std::hash<std::string>()(key.text);
+            h ^= std::hash<const void*>()(key.font) + 0x9E3779B9u + (h << 6) + (h >> 2);
+            h ^= static_cast<size_t>(key.max_width) * 0x85EBCA6Bu;
+            return h;
+        }
+    };
+
+    // Views truncate a few dozen distinct strings; the memo is dropped
+    // wholesale if it ever grows past this instead of tracking recency.
+    static constexpr size_t kMaxTruncateEntries = 1024;
+
+    std::string TruncateUncached(TTF_Font* font, const std::string& text, int max_width);
+    // The face that draws `codepoint` when text is set in `font`.
+    TTF_Font* FaceFor(TTF_Font* font, uint32_t codepoint);
+
+    FontRegistry* fonts_ = nullptr;
+    std::unordered_map<TTF_Font*, FontAdvances> advances_;
+    std::unordered_map<TruncateKey, std::string, TruncateKeyHash> truncated_;
+
+    // Scratch for TruncateUncached, kept to avoid reallocating per call.
+    std::vector<uint32_t> codepoints_;
+    std::vector<TTF_Font*> faces_;
+    std::vector<size_t> offsets_;
+    std::vector<int> prefix_;
+};
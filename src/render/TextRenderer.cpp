@@ -0,0 +1,255 @@
+#include "render/TextRenderer.h"
+
+#include "render/FontRegistry.h"
+#include "render/TextCache.h"
+#include "util/PerfCounters.h"
+#include "util/Utf8.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+bool IsBlank(uint32_t codepoint) {
+    return codepoint == ' ' || codepoint == '\t' || codepoint < 0x20;
+}
+
+} // namespace
+
+TextRenderer::TextRenderer(SDL_Renderer* renderer, int atlas_size, size_t cache_budget_bytes)
+    : renderer_(renderer),
+      cache_(std::make_unique<TextCache>(this, cache_budget_bytes)),
+      atlas_size_(std::max(kMinAtlasSize, atlas_size)) {}
+
+TextRenderer::~TextRenderer() {
+    if (atlas_) {
+        SDL_DestroyTexture(atlas_);
+    }
+}
+
+void TextRenderer::UseFonts(FontRegistry* fonts) {
+    fonts_ = fonts;
+    measure_.UseFonts(fonts);
+}
+
+void TextRenderer::Layout(TTF_Font* font, const std::string& text, TextLayout* out) {
+    // A glyph that does not fit clears the atlas, which invalidates slots
+    // handed out earlier in the same string; lay it out once more.
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        out->Clear();
+        out->font = font;
+        out->generation = generation_;
+        if (!font || text.empty()) {
+            return;
+        }
+        out->h = TTF_FontHeight(font);
+        int ascent = TTF_FontAscent(font);
+
+        int pen = 0;
+        int right = 0;
+        uint32_t previous = 0;
+        TTF_Font* previous_face = nullptr;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            uint32_t codepoint = Utf8::DecodeNext(text, &pos);
+            // A coverage bit test per codepoint; kerning only applies
+            // within a run of one face.
+            TTF_Font* face = fonts_ ? fonts_->FaceFor(font, codepoint) : font;
+            if (previous != 0 && face == previous_face) {
+                pen += TextMeasure::Kerning(face, previous, codepoint);
+            }
+            previous = codepoint;
+            previous_face = face;
+            uint32_t slot = 0;
+            if (!FindOrAddGlyph(face, codepoint, &slot)) {
+                continue;
+            }
+            int y = face == font ? 0 : ascent - TTF_FontAscent(face);
+            out->glyphs.push_back(TextLayout::Glyph{ codepoint, pen, y, slot, face });
+            right = std::max(right, pen + slots_[slot].rect.w);
+            pen += slots_[slot].advance;
+        }
+        out->w = std::max(pen, right);
+        if (out->generation == generation_) {
+            return;
+        }
+    }
+}
+
+void TextRenderer::Draw(const TextLayout& layout, const SDL_Rect& dst, SDL_Color color) {
+    if (layout.glyphs.empty() || layout.w <= 0 || layout.h <= 0 || !layout.font) {
+        return;
+    }
+    float sx = dst.w > 0 ? static_cast<float>(dst.w) / static_cast<float>(layout.w) : 1.0f;
+    float sy = dst.h > 0 ? static_cast<float>(dst.h) / static_cast<float>(layout.h) : 1.0f;
+    bool stale = layout.generation != generation_;
+    for (const auto& glyph : layout.glyphs) {
+        uint32_t slot = glyph.slot;
+        if (stale && !FindOrAddGlyph(glyph.face, glyph.codepoint, &slot)) {
+            continue;
+        }
+        const SDL_Rect& src = slots_[slot].rect;
+        if (src.w <= 0 || src.h <= 0) {
+            continue;
+        }
+        QueueQuad(src, static_cast<float>(dst.x) + static_cast<float>(glyph.x) * sx,
+                  static_cast<float>(dst.y) + static_cast<float>(glyph.y) * sy,
+                  static_cast<float>(src.w) * sx, static_cast<float>(src.h) * sy, color);
+    }
+}
+
+void TextRenderer::QueueQuad(const SDL_Rect& src, float x, float y, float w, float h, SDL_Color color) {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    const float inv = 1.0f / static_cast<float>(atlas_size_);
+    float u0 = static_cast<float>(src.x) * inv;
+    float v0 = static_cast<float>(src.y) * inv;
+    float u1 = static_cast<float>(src.x + src.w) * inv;
+    float v1 = static_cast<float>(src.y + src.h) * inv;
+
+    int base = static_cast<int>(vertices_.size());
+    vertices_.push_back(SDL_Vertex{ SDL_FPoint{ x, y }, color, SDL_FPoint{ u0, v0 } });
+    vertices_.push_back(SDL_Vertex{ SDL_FPoint{ x + w, y }, color, SDL_FPoint{ u1, v0 } });
+    vertices_.push_back(SDL_Vertex{ SDL_FPoint{ x + w, y + h }, color, SDL_FPoint{ u1, v1 } });
+    vertices_.push_back(SDL_Vertex{ SDL_FPoint{ x, y + h }, color, SDL_FPoint{ u0, v1 } });
+    indices_.insert(indices_.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+#else
+    // No SDL_RenderGeometry before SDL 2.0.18: copy glyph by glyph, still
+    // from the one atlas texture.
+    SDL_SetTextureColorMod(atlas_, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(atlas_, color.a);
+    SDL_Rect dst{ static_cast<int>(x), static_cast<int>(y), static_cast<int>(w + 0.5f), static_cast<int>(h + 0.5f) };
+    SDL_RenderCopy(renderer_, atlas_, &src, &dst);
+    PerfCounters::AddDrawCall();
+#endif
+}
+
+void TextRenderer::Flush() {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    if (vertices_.empty() || !atlas_) {
+        return;
+    }
+    if (SDL_RenderGeometry(renderer_, atlas_, vertices_.data(), static_cast<int>(vertices_.size()),
+                           indices_.data(), static_cast<int>(indices_.size())) != 0) {
+        std::cerr << "SDL_RenderGeometry failed: " << SDL_GetError() << "\n";
+    }
+    PerfCounters::AddDrawCall();
+    vertices_.clear();
+    indices_.clear();
+#endif
+}
+
+void TextRenderer::Reset() {
+    vertices_.clear();
+    indices_.clear();
+    if (atlas_) {
+        SDL_DestroyTexture(atlas_);
+        atlas_ = nullptr;
+    }
+    index_.clear();
+    slots_.clear();
+    shelf_x_ = 0;
+    shelf_y_ = 0;
+    shelf_h_ = 0;
+    ++generation_;
+    measure_.Clear();
+}
+
+size_t TextRenderer::AtlasBytes() const {
+    return atlas_ ? static_cast<size_t>(atlas_size_) * atlas_size_ * 4 : 0;
+}
+
+bool TextRenderer::EnsureAtlas() {
+    if (atlas_) {
+        return true;
+    }
+    atlas_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, atlas_size_, atlas_size_);
+    if (!atlas_) {
+        std::cerr << "SDL_CreateTexture (glyph atlas) failed: " << SDL_GetError() << "\n";
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas_, SDL_BLENDMODE_BLEND);
+    std::vector<Uint32> clear(static_cast<size_t>(atlas_size_) * atlas_size_, 0);
+    SDL_UpdateTexture(atlas_, nullptr, clear.data(), atlas_size_ * 4);
+    PerfCounters::AddTextureCreated(clear.size() * 4);
+    return true;
+}
+
+void TextRenderer::ClearAtlas() {
+    // Queued quads still point at the old contents, so draw them first.
+    Flush();
+    index_.clear();
+    slots_.clear();
+    shelf_x_ = 0;
+    shelf_y_ = 0;
+    shelf_h_ = 0;
+    ++generation_;
+    std::vector<Uint32> clear(static_cast<size_t>(atlas_size_) * atlas_size_, 0);
+    SDL_UpdateTexture(atlas_, nullptr, clear.data(), atlas_size_ * 4);
+    PerfCounters::AddTextureUpload(clear.size() * 4);
+}
+
+bool TextRenderer::Pack(int w, int h, SDL_Rect* out) {
+    int padded_w = w + kPadding;
+    int padded_h = h + kPadding;
+    if (padded_w > atlas_size_ || padded_h > atlas_size_) {
+        return false;
+    }
+    if (shelf_x_ + padded_w > atlas_size_) {
+        shelf_y_ += shelf_h_;
+        shelf_x_ = 0;
+        shelf_h_ = 0;
+    }
+    if (shelf_y_ + padded_h > atlas_size_) {
+        return false;
+    }
+    *out = SDL_Rect{ shelf_x_, shelf_y_, w, h };
+    shelf_x_ += padded_w;
+    shelf_h_ = std::max(shelf_h_, padded_h);
+    return true;
+}
+
+bool TextRenderer::FindOrAddGlyph(TTF_Font* font, uint32_t codepoint, uint32_t* slot) {
+    auto it = index_.find(GlyphKey{ font, codepoint });
+    if (it != index_.end()) {
+        *slot = it->second;
+        return true;
+    }
+    if (!EnsureAtlas()) {
+        return false;
+    }
+
+    Slot entry;
+    entry.advance = measure_.Advance(font, codepoint);
+    if (!IsBlank(codepoint)) {
+        std::string utf8;
+        Utf8::Append(codepoint, &utf8);
+        SDL_Surface* surface = TTF_RenderUTF8_Blended(font, utf8.c_str(), SDL_Color{ 255, 255, 255, 255 });
+        if (!surface) {
+            std::cerr << "TTF_RenderUTF8_Blended failed: " << TTF_GetError() << "\n";
+            return false;
+        }
+        if (entry.advance == 0) {
+            entry.advance = surface->w;
+        }
+        SDL_Rect rect{ 0, 0, 0, 0 };
+        bool packed = Pack(surface->w, surface->h, &rect);
+        if (!packed) {
+            ClearAtlas();
+            packed = Pack(surface->w, surface->h, &rect);
+        }
+        if (packed) {
+            SDL_UpdateTexture(atlas_, &rect, surface->pixels, surface->pitch);
+            PerfCounters::AddTextureUpload(static_cast<size_t>(surface->pitch) * surface->h);
+            entry.rect = rect;
+        }
+        SDL_FreeSurface(surface);
+        if (!packed) {
+            return false;
+        }
+    }
+
+    *slot = static_cast<uint32_t>(slots_.size());
+    slots_.push_back(entry);
+    index_.emplace(GlyphKey{ font, codepoint }, *slot);
+    return true;
+}
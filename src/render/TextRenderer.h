@@ -0,0 +1,142 @@
+#pragma once
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "render/TextMeasure.h"
+
+class FontRegistry;
+class TextCache;
+
+// A string laid out against the glyph atlas: pen positions plus the atlas
+// slot of each glyph. Changing the text only rebuilds this, it never
+// rasterises the whole string or creates a texture.
+struct TextLayout {
+    struct Glyph {
+        uint32_t codepoint = 0;
+        int x = 0;
+        // Baseline shift for glyphs taken from a fallback face.
+        int y = 0;
+        uint32_t slot = 0;
+        // The requested face, or the fallback that has this codepoint.
+        TTF_Font* face = nullptr;
+    };
+
+    // The requested face; also sets the line height.
+    TTF_Font* font = nullptr;
+    std::vector<Glyph> glyphs;
+    int w = 0;
+    int h = 0;
+    // Atlas generation the slots refer to; stale slots are looked up again.
+    uint32_t generation = 0;
+
+    bool Empty() const { return glyphs.empty(); }
+    void Clear() {
+        glyphs.clear();
+        w = 0;
+        h = 0;
+    }
+};
+
+// Draws text from one atlas texture shared by every face. Glyphs are
+// rasterised once with SDL_ttf and packed on shelves; text is queued as
+// coloured quads and submitted with a single SDL_RenderGeometry per Flush.
+class TextRenderer {
+public:
+    static constexpr int kDefaultAtlasSize = 1024;
+    static constexpr size_t kDefaultCacheBytes = 256 * 1024;
+
+    // `atlas_size` is the edge of the square glyph atlas, i.e. the GPU
+    // memory text may use (4 bytes per texel); `cache_budget_bytes` bounds
+    // the shared layout cache.
+    explicit TextRenderer(SDL_Renderer* renderer, int atlas_size = kDefaultAtlasSize,
+                          size_t cache_budget_bytes = kDefaultCacheBytes);
+    ~TextRenderer();
+
+    TextRenderer(const TextRenderer&) = delete;
+    TextRenderer& operator=(const TextRenderer&) = delete;
+
+    // Splits text into runs per face by glyph coverage, so codepoints the
+    // requested font lacks come from the configured fallbacks. Without it
+    // every glyph uses the requested font. Call before laying out text.
+    void UseFonts(FontRegistry* fonts);
+
+    void Layout(TTF_Font* font, const std::string& text, TextLayout* out);
+
+    // Queues `layout` at `dst`, scaled when dst differs from the layout size.
+    void Draw(const TextLayout& layout, const SDL_Rect& dst, SDL_Color color);
+
+    // Submits queued text. Call before drawing anything that must appear on
+    // top of it and at the end of each layer.
+    void Flush();
+
+    // Drops the atlas, e.g. after SDL_RENDER_DEVICE_RESET lost all textures.
+    void Reset();
+
+    size_t AtlasBytes() const;
+
+    // Width and truncation queries share the renderer's advance cache.
+    TextMeasure& Measure() { return measure_; }
+
+    // Layouts shared between views, keyed by (font, text).
+    TextCache& Cache() { return *cache_; }
+
+    // Bumped whenever the atlas is cleared; layouts from an older generation
+    // still draw, but look their glyphs up again.
+    uint32_t Generation() const { return generation_; }
+
+private:
+    struct GlyphKey {
+        TTF_Font* font;
+        uint32_t codepoint;
+        bool operator==(const GlyphKey& other) const {
+            return font == other.font && codepoint == other.codepoint;
+        }
+    };
+
+    struct GlyphKeyHash {
+        size_t operator()(const GlyphKey& key) const {
+            return std::hash<const void*>()(key.font) ^ (static_cast<size_t>(key.codepoint) * 0x9E3779B1u);
+        }
+    };
+
+    struct Slot {
+        SDL_Rect rect{ 0, 0, 0, 0 };
+        int advance = 0;
+    };
+
+    static constexpr int kMinAtlasSize = 256;
+    static constexpr int kPadding = 1;
+
+    bool EnsureAtlas();
+    void ClearAtlas();
+    bool FindOrAddGlyph(TTF_Font* font, uint32_t codepoint, uint32_t* slot);
+    bool Pack(int w, int h, SDL_Rect* out);
+    void QueueQuad(const SDL_Rect& src, float x, float y, float w, float h, SDL_Color color);
+
+    SDL_Renderer* renderer_;
+    FontRegistry* fonts_ = nullptr;
+    TextMeasure measure_;
+    std::unique_ptr<TextCache> cache_;
+    int atlas_size_;
+    SDL_Texture* atlas_ = nullptr;
+    uint32_t generation_ = 1;
+
+    int shelf_x_ = 0;
+    int shelf_y_ = 0;
+    int shelf_h_ = 0;
+
+    std::unordered_map<GlyphKey, uint32_t, GlyphKeyHash> index_;
+    std::vector<Slot> slots_;
+
+    std::vector<SDL_Vertex> vertices_;
+    std::vector<int> indices_;
+};
@@ -1,6 +1,8 @@
 #include "services/CalendarSyncService.h"
 
+#include "db/EventSnapshot.h"
 #include "db/EventStore.h"
+#include "db/MetaSnapshot.h"
 #include "util/TimeUtil.h"
 
 #include <curl/curl.h>
@@ -8,8 +10,10 @@
 #include <cctype>
 #include <ctime>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <thread>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -468,7 +472,8 @@ bool FetchIcsEvents(CURL* curl, const SyncConfig& config, EventStore* store, int
     bool has_end = false;
     bool start_is_date = false;
     bool end_is_date = false;
-    size_t stored_events = 0;
+    // Applied in one transaction once the whole feed has parsed.
+    std::vector<EventRecord> events;
     int64_t now_ts = TimeUtil::NowTs();
     int64_t window_end = now_ts + static_cast<int64_t>(config.time_window_days) * 24 * 60 * 60;
 
@@ -522,19 +527,13 @@ bool FetchIcsEvents(CURL* curl, const SyncConfig& config, EventStore* store, int
                 ev.updated_ts = sync_ts;
 
                 if (ev.end_ts >= now_ts && ev.start_ts <= window_end) {
-                    if (stored_events >= kMaxEventsPerSync) {
+                    if (events.size() >= kMaxEventsPerSync) {
                         if (error) {
                             *error = "ics too many events";
                         }
                         return false;
                     }
-                    if (!store->UpsertEvent(ev)) {
-                        if (error) {
-                            *error = "event rejected";
-                        }
-                        return false;
-                    }
-                    ++stored_events;
+                    events.push_back(ev);
                 }
             }
             in_event = false;
@@ -619,7 +618,16 @@ bool FetchIcsEvents(CURL* curl, const SyncConfig& config, EventStore* store, int
         }
     }
 
-    store->DeleteStaleInWindow("ics", now_ts, window_end, sync_ts);
+    SyncWindow window;
+    window.start_ts = now_ts;
+    window.end_ts = window_end;
+    window.sync_ts = sync_ts;
+    if (!store->ApplySync("ics", events, window)) {
+        if (error) {
+            *error = "event rejected";
+        }
+        return false;
+    }
     return true;
 }
 
@@ -650,6 +658,15 @@ bool CalendarSyncService::IsRunning() const {
     return running_.load();
 }
 
+const std::vector<std::string>& CalendarSyncService::StatusMetaKeys() {
+    static const std::vector<std::string> kKeys = {
+        "last_sync_status",
+        "last_sync_ts",
+        "last_sync_error",
+    };
+    return kKeys;
+}
+
 void CalendarSyncService::Run() {
     EventStore store(config_.db_path);
     if (!store.Open()) {
@@ -658,6 +675,7 @@ void CalendarSyncService::Run() {
     }
 
     bool seeded = false;
+    bool published = false;
     bool first_online_sync_done = config_.mock_mode || Trim(config_.ics_url).empty();
     bool internet_down_detected = false;
     int consecutive_failures = 0;
@@ -726,6 +744,21 @@ void CalendarSyncService::Run() {
         } else {
             store.SetMeta("last_sync_error", "");
         }
+        // Only a fresh download or the first pass (mock seeding, or the
+        // cache left by an earlier run) can change the events table. A
+        // failed read keeps the previous snapshot and is retried next pass.
+        if (config_.events && ok && (sync_status == "online" || !published)) {
+            if (std::shared_ptr<const EventSnapshot> snapshot = EventSnapshot::Load(&store)) {
+                config_.events->Publish(std::move(snapshot));
+                published = true;
+            }
+        }
+        if (config_.status) {
+            config_.status->Publish(MetaSnapshot::Load(&store, StatusMetaKeys()));
+        }
+        if (config_.on_data_changed) {
+            config_.on_data_changed();
+        }
 
         if (!first_online_sync_done && !ok) {
             if (error == "no internet" ||
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <string>
 #include <thread>
+#include <vector>
+
+class EventSnapshotSlot;
 class EventStore;
+class MetaSnapshotSlot;
 
 struct SyncConfig {
     std::string db_path;
@@ -11,6 +16,14 @@ struct SyncConfig {
     int sync_interval_sec = 120;
     int time_window_days = 14;
     bool mock_mode = false;
+    // Receives a fresh snapshot of the events table after each sync that
+    // may have changed it, before on_data_changed runs. Optional.
+    EventSnapshotSlot* events = nullptr;
+    // Receives the StatusMetaKeys values after each sync attempt, before
+    // on_data_changed runs. Optional.
+    MetaSnapshotSlot* status = nullptr;
+    // Invoked on the sync thread after each sync attempt has written its results.
+    std::function<void()> on_data_changed;
 };
 
 class CalendarSyncService {
@@ -22,6 +35,9 @@ public:
     void Stop();
     bool IsRunning() const;
 
+    // The meta keys each sync attempt records its outcome under.
+    static const std::vector<std::string>& StatusMetaKeys();
+
 private:
     void Run();
     bool SyncOnce(EventStore* store, std::string* error);
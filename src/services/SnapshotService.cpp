@@ -0,0 +1,157 @@
+#include "services/SnapshotService.h"
+
+#include <SDL_image.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+
+SnapshotService::SnapshotService(const SnapshotConfig& config) : config_(config) {
+    size_t count = std::max<size_t>(1, config_.buffer_count);
+    for (size_t i = 0; i < count; ++i) {
+        free_frames_.push_back(std::make_unique<Frame>());
+    }
+    next_periodic_ = std::chrono::steady_clock::now() + std::chrono::seconds(config_.interval_sec);
+}
+
+SnapshotService::~SnapshotService() {
+    Stop();
+}
+
+void SnapshotService::Start() {
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    worker_ = std::thread(&SnapshotService::Run, this);
+}
+
+void SnapshotService::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool SnapshotService::IsRunning() const {
+    return running_;
+}
+
+bool SnapshotService::Capture(SDL_Renderer* renderer, int width, int height, const std::string& path) {
+    if (!running_ || width <= 0 || height <= 0 || path.empty()) {
+        return false;
+    }
+
+    std::unique_ptr<Frame> frame;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_frames_.empty()) {
+            std::cerr << "Snapshot skipped: encoder is still busy.\n";
+            return false;
+        }
+        frame = std::move(free_frames_.back());
+        free_frames_.pop_back();
+    }
+
+    // Buffers keep their capacity, so steady-state captures do not allocate.
+    frame->width = width;
+    frame->height = height;
+    frame->pitch = width * 4;
+    frame->pixels.resize(static_cast<size_t>(frame->pitch) * static_cast<size_t>(height));
+    frame->path = path;
+
+    bool ok = SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888,
+                                   frame->pixels.data(), frame->pitch) == 0;
+    if (!ok) {
+        std::cerr << "SDL_RenderReadPixels failed: " << SDL_GetError() << "\n";
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ok) {
+            pending_frames_.push_back(std::move(frame));
+        } else {
+            free_frames_.push_back(std::move(frame));
+        }
+    }
+    if (ok) {
+        cv_.notify_one();
+    }
+    return ok;
+}
+
+bool SnapshotService::IsPeriodicDue(std::chrono::steady_clock::time_point now) const {
+    return config_.interval_sec > 0 && now >= next_periodic_;
+}
+
+int SnapshotService::MsUntilPeriodic(std::chrono::steady_clock::time_point now) const {
+    if (config_.interval_sec <= 0) {
+        return -1;
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(next_periodic_ - now).count();
+    return static_cast<int>(std::max<int64_t>(0, ms));
+}
+
+void SnapshotService::MarkPeriodicTaken(std::chrono::steady_clock::time_point now) {
+    next_periodic_ = now + std::chrono::seconds(config_.interval_sec);
+}
+
+void SnapshotService::Run() {
+    while (true) {
+        std::unique_ptr<Frame> frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return !running_ || !pending_frames_.empty(); });
+            if (pending_frames_.empty()) {
+                return;
+            }
+            frame = std::move(pending_frames_.front());
+            pending_frames_.pop_front();
+        }
+
+        Encode(*frame);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_frames_.push_back(std::move(frame));
+    }
+}
+
+bool SnapshotService::Encode(const Frame& frame) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+        const_cast<uint8_t*>(frame.pixels.data()), frame.width, frame.height, 32, frame.pitch,
+        SDL_PIXELFORMAT_ARGB8888);
+    if (!surface) {
+        std::cerr << "SDL_CreateRGBSurfaceWithFormatFrom failed: " << SDL_GetError() << "\n";
+        return false;
+    }
+
+    std::filesystem::path target(frame.path);
+    std::error_code ec;
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), ec);
+    }
+
+    // Write next to the target and rename, so readers never see a partial PNG.
+    std::string tmp_path = frame.path + ".tmp";
+    bool ok = IMG_SavePNG(surface, tmp_path.c_str()) == 0;
+    SDL_FreeSurface(surface);
+    if (!ok) {
+        std::cerr << "IMG_SavePNG failed: " << IMG_GetError() << "\n";
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    std::filesystem::rename(tmp_path, target, ec);
+    if (ec) {
+        std::cerr << "Failed to move snapshot into place: " << ec.message() << "\n";
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SnapshotConfig {
+    // Target for manual captures (S key).
+    std::string screenshot_path;
+    // Target for periodic captures; disabled when interval_sec is 0.
+    std::string snapshot_path;
+    int interval_sec = 0;
+    // Number of readback buffers; captures are dropped while all are in use.
+    size_t buffer_count = 2;
+};
+
+// Reads frames back on the render thread into pooled buffers and encodes
+// them to PNG on a worker thread, so disk I/O never stalls the main loop.
+class SnapshotService {
+public:
+    explicit SnapshotService(const SnapshotConfig& config);
+    ~SnapshotService();
+
+    void Start();
+    void Stop();
+    bool IsRunning() const;
+
+    // Copies the current render target into a free buffer and queues it for
+    // encoding to `path`. Must be called before SDL_RenderPresent.
+    bool Capture(SDL_Renderer* renderer, int width, int height, const std::string& path);
+
+    bool IsPeriodicDue(std::chrono::steady_clock::time_point now) const;
+    // Milliseconds until the next periodic capture, or -1 when disabled.
+    int MsUntilPeriodic(std::chrono::steady_clock::time_point now) const;
+    void MarkPeriodicTaken(std::chrono::steady_clock::time_point now);
+
+    const SnapshotConfig& Config() const { return config_; }
+
+private:
+    struct Frame {
+        std::vector<uint8_t> pixels;
+        int width = 0;
+        int height = 0;
+        int pitch = 0;
+        std::string path;
+    };
+
+    void Run();
+    bool Encode(const Frame& frame);
+
+    SnapshotConfig config_;
+    std::atomic<bool> running_{false};
+    std::thread worker_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<Frame>> free_frames_;
+    std::deque<std::unique_ptr<Frame>> pending_frames_;
+
+    std::chrono::steady_clock::time_point next_periodic_{};
+};
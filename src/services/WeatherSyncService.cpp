@@ -1,6 +1,7 @@
 #include "services/WeatherSyncService.h"
 
 #include "db/EventStore.h"
+#include "db/MetaSnapshot.h"
 #include "util/TimeUtil.h"
 
 #include <curl/curl.h>
@@ -172,6 +173,22 @@ bool WeatherSyncService::IsRunning() const {
     return running_.load();
 }
 
+const std::vector<std::string>& WeatherSyncService::MetaKeys() {
+    static const std::vector<std::string> kKeys = {
+        "weather_status",
+        "weather_last_sync_ts",
+        "weather_error",
+        "weather_temp_c",
+        "weather_code",
+        "weather_is_day",
+        "weather_summary",
+        "weather_wind_kmh",
+        "weather_hourly_json",
+        "weather_daily_json",
+    };
+    return kKeys;
+}
+
 void WeatherSyncService::Run() {
     EventStore store(config_.db_path);
     if (!store.Open()) {
@@ -233,6 +250,12 @@ void WeatherSyncService::Run() {
         } else {
             store.SetMeta("weather_error", "");
         }
+        if (config_.weather) {
+            config_.weather->Publish(MetaSnapshot::Load(&store, MetaKeys()));
+        }
+        if (config_.on_data_changed) {
+            config_.on_data_changed();
+        }
 
         if (!first_online_sync_done && !ok) {
             if (error == "no internet" ||
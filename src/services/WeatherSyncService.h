@@ -1,10 +1,13 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <string>
 #include <thread>
+#include <vector>
 
 class EventStore;
+class MetaSnapshotSlot;
 
 struct WeatherConfig {
     std::string db_path;
@@ -12,6 +15,11 @@ struct WeatherConfig {
     double latitude = 0.0;
     double longitude = 0.0;
     int sync_interval_sec = 900;
+    // Receives the MetaKeys values after each sync attempt, before
+    // on_data_changed runs. Optional.
+    MetaSnapshotSlot* weather = nullptr;
+    // Invoked on the sync thread after each sync attempt has written its results.
+    std::function<void()> on_data_changed;
 };
 
 class WeatherSyncService {
@@ -23,6 +31,9 @@ public:
     void Stop();
     bool IsRunning() const;
 
+    // The meta keys the current conditions and forecast are stored under.
+    static const std::vector<std::string>& MetaKeys();
+
 private:
     void Run();
     bool SyncOnce(EventStore* store, std::string* error);
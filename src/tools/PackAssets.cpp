@@ -0,0 +1,250 @@
+#include "render/AssetPack.h"
+#include "render/GlyphCoverage.h"
+
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_ttf.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Build-time packer for the asset pack the app maps at startup (see
+// render/AssetPack.h for the format):
+//
+//   rpi_calendar_pack OUTPUT [--font FILE]... [--sprites DIR]...
+//
+// Fonts are stored as-is, each with its glyph coverage bitmap so the app
+// does not probe FreeType for it at startup. Every PNG in a sprite directory is decoded here,
+// once, into ARGB8888 so the app never inflates a PNG.
+
+namespace {
+
+struct PendingEntry {
+    std::string name;
+    AssetPackFormat::EntryKind kind = AssetPackFormat::EntryKind::Blob;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t pitch = 0;
+    std::vector<uint8_t> data;
+};
+
+bool ReadFile(const std::string& path, std::vector<uint8_t>* out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    out->assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+bool AddFont(const std::string& path, std::vector<PendingEntry>* entries) {
+    PendingEntry entry;
+    entry.name = AssetPack::FontName(path);
+    if (!ReadFile(path, &entry.data) || entry.data.empty()) {
+        std::cerr << "Cannot read font " << path << "\n";
+        return false;
+    }
+
+    // Coverage does not depend on size; any size opens the face.
+    SDL_RWops* rw = SDL_RWFromConstMem(entry.data.data(), static_cast<int>(entry.data.size()));
+    TTF_Font* font = rw ? TTF_OpenFontRW(rw, 1, 16) : nullptr;
+    if (!font) {
+        std::cerr << "Cannot open font " << path << ": " << TTF_GetError() << "\n";
+        return false;
+    }
+    GlyphCoverage coverage;
+    coverage.Build(font);
+    TTF_CloseFont(font);
+    PendingEntry coverage_entry;
+    coverage_entry.name = AssetPack::CoverageName(path);
+    const uint8_t* bits = static_cast<const uint8_t*>(coverage.Data());
+    coverage_entry.data.assign(bits, bits + coverage.ByteSize());
+
+    entries->push_back(std::move(entry));
+    entries->push_back(std::move(coverage_entry));
+    return true;
+}
+
+bool AddSprite(const std::string& dir, const std::string& file, std::vector<PendingEntry>* entries) {
+    std::string path = (std::filesystem::path(dir) / file).string();
+    SDL_Surface* loaded = IMG_Load(path.c_str());
+    if (!loaded) {
+        std::cerr << "Cannot decode " << path << ": " << IMG_GetError() << "\n";
+        return false;
+    }
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded);
+    if (!surface) {
+        std::cerr << "Cannot convert " << path << ": " << SDL_GetError() << "\n";
+        return false;
+    }
+
+    PendingEntry entry;
+    entry.name = AssetPack::SpriteName(dir, file);
+    entry.kind = AssetPackFormat::EntryKind::Image;
+    entry.width = static_cast<uint32_t>(surface->w);
+    entry.height = static_cast<uint32_t>(surface->h);
+    entry.pitch = entry.width * 4;
+    entry.data.resize(static_cast<size_t>(entry.pitch) * entry.height);
+    SDL_LockSurface(surface);
+    for (int y = 0; y < surface->h; ++y) {
+        std::memcpy(entry.data.data() + static_cast<size_t>(y) * entry.pitch,
+                    static_cast<const uint8_t*>(surface->pixels) + static_cast<size_t>(y) * surface->pitch,
+                    entry.pitch);
+    }
+    SDL_UnlockSurface(surface);
+    SDL_FreeSurface(surface);
+    entries->push_back(std::move(entry));
+    return true;
+}
+
+bool AddSpriteDir(const std::string& dir, std::vector<PendingEntry>* entries) {
+    std::error_code ec;
+    std::vector<std::string> files;
+    for (const auto& item : std::filesystem::directory_iterator(dir, ec)) {
+        if (item.is_regular_file() && item.path().extension() == ".png") {
+            files.push_back(item.path().filename().string());
+        }
+    }
+    if (ec) {
+        std::cerr << "Cannot list " << dir << ": " << ec.message() << "\n";
+        return false;
+    }
+    // Stable output for identical inputs.
+    std::sort(files.begin(), files.end());
+    for (const std::string& file : files) {
+        if (!AddSprite(dir, file, entries)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t AlignUp(size_t value) {
+    return (value + AssetPackFormat::kAlignment - 1) / AssetPackFormat::kAlignment * AssetPackFormat::kAlignment;
+}
+
+bool WritePack(const std::string& path, const std::vector<PendingEntry>& entries) {
+    using namespace AssetPackFormat;
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrderMark;
+    header.entry_count = static_cast<uint32_t>(entries.size());
+
+    std::vector<Entry> records(entries.size());
+    size_t offset = AlignUp(sizeof(Header) + sizeof(Entry) * entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const PendingEntry& pending = entries[i];
+        if (pending.name.size() >= kNameBytes) {
+            std::cerr << "Asset name too long: " << pending.name << "\n";
+            return false;
+        }
+        Entry& record = records[i];
+        std::memset(&record, 0, sizeof(record));
+        std::memcpy(record.name, pending.name.data(), pending.name.size());
+        record.kind = static_cast<uint32_t>(pending.kind);
+        record.width = pending.width;
+        record.height = pending.height;
+        record.pitch = pending.pitch;
+        record.offset = offset;
+        record.size = pending.data.size();
+        offset = AlignUp(offset + pending.data.size());
+    }
+
+    // Written next to the target and renamed, so a running app never maps
+    // a half-written pack.
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Cannot write " << temp_path << "\n";
+            return false;
+        }
+        auto pad_to = [&out](size_t target) {
+            static const char zeros[kAlignment] = {};
+            size_t at = static_cast<size_t>(out.tellp());
+            out.write(zeros, static_cast<std::streamsize>(target - at));
+        };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()),
+                  static_cast<std::streamsize>(sizeof(Entry) * records.size()));
+        for (size_t i = 0; i < entries.size(); ++i) {
+            pad_to(static_cast<size_t>(records[i].offset));
+            out.write(reinterpret_cast<const char*>(entries[i].data.data()),
+                      static_cast<std::streamsize>(entries[i].data.size()));
+        }
+        if (!out) {
+            std::cerr << "Failed writing " << temp_path << "\n";
+            return false;
+        }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Cannot rename " << temp_path << " to " << path << "\n";
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+void PrintUsage() {
+    std::cerr << "Usage: rpi_calendar_pack OUTPUT [--font FILE]... [--sprites DIR]...\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        PrintUsage();
+        return 2;
+    }
+    std::string output = argv[1];
+    std::vector<std::string> fonts;
+    std::vector<std::string> sprite_dirs;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--font" && has_value) {
+            fonts.push_back(argv[++i]);
+        } else if (arg == "--sprites" && has_value) {
+            sprite_dirs.push_back(argv[++i]);
+        } else {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    if (TTF_Init() != 0) {
+        std::cerr << "TTF_Init failed: " << TTF_GetError() << "\n";
+        return 1;
+    }
+    IMG_Init(IMG_INIT_PNG);
+    std::vector<PendingEntry> entries;
+    bool ok = true;
+    for (const std::string& font : fonts) {
+        ok = ok && AddFont(font, &entries);
+    }
+    for (const std::string& dir : sprite_dirs) {
+        ok = ok && AddSpriteDir(dir, &entries);
+    }
+    ok = ok && WritePack(output, entries);
+    IMG_Quit();
+    TTF_Quit();
+    if (!ok) {
+        return 1;
+    }
+
+    size_t bytes = 0;
+    for (const PendingEntry& entry : entries) {
+        bytes += entry.data.size();
+    }
+    std::cout << "Packed " << entries.size() << " assets (" << (bytes / 1024) << " KB) into " << output << "\n";
+    return 0;
+}
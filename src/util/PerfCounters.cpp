@@ -0,0 +1,41 @@
+#include "util/PerfCounters.h"
+
+namespace PerfCounters {
+
+namespace {
+
+thread_local Snapshot g_counters;
+
+} // namespace
+
+void AddSqlQuery() {
+    ++g_counters.sql_queries;
+}
+
+void AddTextureCreated(size_t upload_bytes) {
+    ++g_counters.textures_created;
+    g_counters.texture_bytes += upload_bytes;
+}
+
+void AddTextureUpload(size_t upload_bytes) {
+    g_counters.texture_bytes += upload_bytes;
+}
+
+void AddDrawCall() {
+    ++g_counters.draw_calls;
+}
+
+Snapshot Read() {
+    return g_counters;
+}
+
+Snapshot Delta(const Snapshot& before, const Snapshot& after) {
+    Snapshot out;
+    out.sql_queries = after.sql_queries - before.sql_queries;
+    out.textures_created = after.textures_created - before.textures_created;
+    out.texture_bytes = after.texture_bytes - before.texture_bytes;
+    out.draw_calls = after.draw_calls - before.draw_calls;
+    return out;
+}
+
+} // namespace PerfCounters
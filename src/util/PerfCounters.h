@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Cheap per-thread cost counters. Each thread counts its own work, so the
+// frame profiler on the render thread only sees what the render thread did,
+// not the sync services' writes.
+namespace PerfCounters {
+
+struct Snapshot {
+    uint64_t sql_queries = 0;
+    uint64_t textures_created = 0;
+    uint64_t texture_bytes = 0;
+    uint64_t draw_calls = 0;
+};
+
+void AddSqlQuery();
+void AddTextureCreated(size_t upload_bytes);
+// Pixels written into an existing texture, e.g. a glyph added to the atlas.
+void AddTextureUpload(size_t upload_bytes);
+// One renderer submission: a copy, a fill batch, a geometry call.
+void AddDrawCall();
+Snapshot Read();
+Snapshot Delta(const Snapshot& before, const Snapshot& after);
+
+} // namespace PerfCounters
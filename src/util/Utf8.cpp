@@ -0,0 +1,66 @@
+#include "util/Utf8.h"
+
+namespace Utf8 {
+
+uint32_t DecodeNext(const std::string& text, size_t* pos) {
+    size_t i = *pos;
+    unsigned char lead = static_cast<unsigned char>(text[i]);
+    size_t len = 0;
+    uint32_t cp = 0;
+    if (lead < 0x80) {
+        *pos = i + 1;
+        return lead;
+    } else if ((lead & 0xE0) == 0xC0) {
+        len = 2;
+        cp = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        len = 3;
+        cp = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        len = 4;
+        cp = lead & 0x07;
+    } else {
+        *pos = i + 1;
+        return kReplacementChar;
+    }
+    if (i + len > text.size()) {
+        *pos = i + 1;
+        return kReplacementChar;
+    }
+    for (size_t k = 1; k < len; ++k) {
+        unsigned char c = static_cast<unsigned char>(text[i + k]);
+        if ((c & 0xC0) != 0x80) {
+            *pos = i + 1;
+            return kReplacementChar;
+        }
+        cp = (cp << 6) | (c & 0x3F);
+    }
+    // Reject overlong forms, surrogates and values past U+10FFFF.
+    static const uint32_t kMinForLength[] = { 0, 0, 0x80, 0x800, 0x10000 };
+    if (cp < kMinForLength[len] || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) {
+        *pos = i + 1;
+        return kReplacementChar;
+    }
+    *pos = i + len;
+    return cp;
+}
+
+void Append(uint32_t cp, std::string* out) {
+    if (cp < 0x80) {
+        out->push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out->push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out->push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out->push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+} // namespace Utf8
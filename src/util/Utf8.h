@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Utf8 {
+
+constexpr uint32_t kReplacementChar = 0xFFFD;
+
+// Decodes the codepoint starting at `*pos` and advances `*pos` past it.
+// Malformed or truncated sequences yield U+FFFD and consume one byte.
+uint32_t DecodeNext(const std::string& text, size_t* pos);
+
+// Appends the UTF-8 encoding of `cp` to `out`.
+void Append(uint32_t cp, std::string* out);
+
+} // namespace Utf8
@@ -1,11 +1,14 @@
 #include "views/CalendarView.h"
 
-#include "db/EventStore.h"
+#include "db/EventSnapshot.h"
+#include "db/MetaSnapshot.h"
+#include "util/PerfCounters.h"
 #include "util/TimeUtil.h"
 
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -39,47 +42,13 @@ CalendarLayout ComputeLayout(int width, int height) {
     return layout;
 }
 
-SDL_Texture* RenderText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, SDL_Color color, int* w, int* h) {
-    SDL_Surface* surface = TTF_RenderUTF8_Blended(font, text.c_str(), color);
-    if (!surface) {
-        std::cerr << "TTF_RenderUTF8_Blended failed: " << TTF_GetError() << "\n";
-        return nullptr;
-    }
-    SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!tex) {
-        std::cerr << "SDL_CreateTextureFromSurface failed: " << SDL_GetError() << "\n";
-        SDL_FreeSurface(surface);
-        return nullptr;
-    }
-    *w = surface->w;
-    *h = surface->h;
-    SDL_FreeSurface(surface);
-    return tex;
-}
-
-std::string TruncateText(TTF_Font* font, const std::string& text, int max_width) {
-    int w = 0;
-    int h = 0;
-    if (TTF_SizeUTF8(font, text.c_str(), &w, &h) == 0 && w <= max_width) {
-        return text;
-    }
-    const std::string ellipsis = "...";
-    for (size_t len = text.size(); len > 0; --len) {
-        std::string candidate = text.substr(0, len) + ellipsis;
-        if (TTF_SizeUTF8(font, candidate.c_str(), &w, &h) == 0 && w <= max_width) {
-            return candidate;
-        }
-    }
-    return ellipsis;
-}
-
-std::string SyncStatusText(EventStore* store, int64_t now_ts) {
-    if (!store) {
+std::string SyncStatusText(const MetaSnapshot* meta, int64_t now_ts) {
+    if (!meta) {
         return "Offline";
     }
-    std::string status = store->GetMeta("last_sync_status");
-    std::string ts_str = store->GetMeta("last_sync_ts");
-    std::string err = store->GetMeta("last_sync_error");
+    const std::string& status = meta->Get("last_sync_status");
+    const std::string& ts_str = meta->Get("last_sync_ts");
+    const std::string& err = meta->Get("last_sync_error");
     std::string label = status.empty() ? "Offline" : status;
 
     if (label == "online") {
@@ -127,8 +96,9 @@ std::string SyncStatusText(EventStore* store, int64_t now_ts) {
 
 } // namespace
 
-CalendarView::CalendarView(SDL_Renderer* renderer, TTF_Font* header_font, TTF_Font* day_font, TTF_Font* agenda_font, EventStore* store)
-    : renderer_(renderer), header_font_(header_font), day_font_(day_font), agenda_font_(agenda_font), store_(store) {
+CalendarView::CalendarView(SDL_Renderer* renderer, TextRenderer* text, FontHandle header_font, FontHandle day_font, FontHandle agenda_font,
+                           const EventSnapshotSlot* events, const MetaSnapshotSlot* sync_status)
+    : renderer_(renderer), text_(text), batch_(renderer), header_font_(header_font), day_font_(day_font), agenda_font_(agenda_font), events_(events), sync_status_(sync_status) {
     selected_ts_ = TimeUtil::NowTs();
 }
 
@@ -136,56 +106,36 @@ CalendarView::~CalendarView() {
     ClearCache();
 }
 
-void CalendarView::UpdateText(CachedText& cache, TTF_Font* font, const std::string& text, SDL_Color color) {
-    if (cache.texture && cache.text == text && cache.color.r == color.r && cache.color.g == color.g && cache.color.b == color.b && cache.color.a == color.a) {
-        return;
-    }
-    if (cache.texture) {
-        SDL_DestroyTexture(cache.texture);
-        cache.texture = nullptr;
-    }
-    cache.text = text;
-    cache.color = color;
-    cache.texture = RenderText(renderer_, font, text, color, &cache.w, &cache.h);
-}
-
 void CalendarView::ClearCache() {
-    auto destroy = [](CachedText& cache) {
-        if (cache.texture) {
-            SDL_DestroyTexture(cache.texture);
-            cache.texture = nullptr;
-        }
+    auto clear = [](CachedText& cache) {
+        cache.Clear();
     };
 
-    destroy(month_text_);
-    destroy(sync_text_);
-    destroy(agenda_title_);
-    destroy(more_text_);
+    clear(month_text_);
+    clear(sync_text_);
+    clear(agenda_title_);
+    clear(more_text_);
 
     for (auto& item : day_texts_) {
-        destroy(item);
+        clear(item);
     }
     day_texts_.clear();
 
     for (auto& item : agenda_lines_) {
-        destroy(item);
+        clear(item);
     }
     agenda_lines_.clear();
 }
 
 void CalendarView::RebuildDayTextures(int days_in_month, SDL_Color color) {
-    for (auto& item : day_texts_) {
-        if (item.texture) {
-            SDL_DestroyTexture(item.texture);
-        }
-    }
+    // Day numbers are on screen whenever the calendar is, so pin them.
     day_texts_.assign(days_in_month, CachedText{});
     for (int day = 1; day <= days_in_month; ++day) {
-        UpdateText(day_texts_[day - 1], day_font_, std::to_string(day), color);
+        text_->Cache().Update(&day_texts_[day - 1], day_font_.Get(), std::to_string(day), color, true);
     }
 }
 
-void CalendarView::UpdateCache(int width, int height, int64_t now_ts) {
+bool CalendarView::UpdateCache(int width, int height, int64_t now_ts) {
     CalendarLayout layout = ComputeLayout(width, height);
     std::tm sel_tm = TimeUtil::LocalTime(selected_ts_);
 
@@ -203,57 +153,50 @@ void CalendarView::UpdateCache(int width, int height, int64_t now_ts) {
     SDL_Color dim = { 110, 110, 110, 255 };
 
     if (month_changed || size_changed) {
-        UpdateText(month_text_, header_font_, TimeUtil::FormatMonthYear(selected_ts_), fg);
+        text_->Cache().Update(&month_text_, header_font_.Get(), TimeUtil::FormatMonthYear(selected_ts_), fg);
         int days_in_month = TimeUtil::DaysInMonth(year, month);
         RebuildDayTextures(days_in_month, fg);
     }
 
     if (minute_changed || size_changed || month_changed) {
-        UpdateText(sync_text_, agenda_font_, SyncStatusText(store_, now_ts), dim);
+        std::shared_ptr<const MetaSnapshot> sync_status = sync_status_ ? sync_status_->Current() : nullptr;
+        text_->Cache().Update(&sync_text_, agenda_font_.Get(), SyncStatusText(sync_status.get(), now_ts), dim);
     }
 
-    if (store_ && (minute_changed || month_changed)) {
-        event_days_cache_ = store_->GetEventDaysInMonth(year, month);
-    } else if (!store_) {
+    std::shared_ptr<const EventSnapshot> events = events_ ? events_->Current() : nullptr;
+    if (events && (minute_changed || month_changed)) {
+        event_days_cache_ = events->EventDaysInMonth(year, month);
+    } else if (!events) {
         event_days_cache_.clear();
     }
 
     if (day_changed || minute_changed || size_changed) {
-        UpdateText(agenda_title_, agenda_font_, "Agenda - " + TimeUtil::FormatDateLine(selected_ts_), dim);
+        text_->Cache().Update(&agenda_title_, agenda_font_.Get(), "Agenda - " + TimeUtil::FormatDateLine(selected_ts_), dim);
 
-        for (auto& item : agenda_lines_) {
-            if (item.texture) {
-                SDL_DestroyTexture(item.texture);
-            }
-        }
         agenda_lines_.clear();
         remaining_count_ = 0;
-        if (more_text_.texture) {
-            SDL_DestroyTexture(more_text_.texture);
-            more_text_.texture = nullptr;
-            more_text_.text.clear();
-        }
+        more_text_.Clear();
 
-        std::vector<EventRecord> events = store_ ? store_->GetEventsForDay(selected_ts_) : std::vector<EventRecord>();
+        std::vector<EventRecord> day_events = events ? events->EventsForDay(selected_ts_) : std::vector<EventRecord>();
         int max_lines = 5;
         int shown = 0;
-        for (const auto& ev : events) {
+        for (const auto& ev : day_events) {
             if (shown >= max_lines) {
                 break;
             }
             std::string time_label = ev.all_day ? "All day" : TimeUtil::FormatTimeHHMM(ev.start_ts);
             std::string line = time_label + "  " + ev.title;
-            line = TruncateText(agenda_font_, line, layout.agenda_max_w);
+            line = text_->Measure().Truncate(agenda_font_.Get(), line, layout.agenda_max_w);
             CachedText cache;
-            UpdateText(cache, agenda_font_, line, fg);
+            text_->Cache().Update(&cache, agenda_font_.Get(), line, fg);
             agenda_lines_.push_back(std::move(cache));
             shown++;
         }
 
-        if (events.size() > static_cast<size_t>(max_lines)) {
-            remaining_count_ = static_cast<int>(events.size()) - max_lines;
+        if (day_events.size() > static_cast<size_t>(max_lines)) {
+            remaining_count_ = static_cast<int>(day_events.size()) - max_lines;
             std::string more = "+" + std::to_string(remaining_count_) + " more...";
-            UpdateText(more_text_, agenda_font_, more, dim);
+            text_->Cache().Update(&more_text_, agenda_font_.Get(), more, dim);
         }
     }
 
@@ -263,6 +206,7 @@ void CalendarView::UpdateCache(int width, int height, int64_t now_ts) {
     last_month_ = month;
     last_day_ = day;
     last_minute_ = minute;
+    return size_changed || day_changed || minute_changed;
 }
 
 void CalendarView::MoveSelectionDays(int delta) {
@@ -284,11 +228,47 @@ void CalendarView::JumpToToday() {
     selected_ts_ = TimeUtil::NowTs();
 }
 
+void CalendarView::Invalidate() {
+    last_minute_ = -1;
+}
+
 void CalendarView::Render(int width, int height) {
-    int64_t now_ts = TimeUtil::NowTs();
-    UpdateCache(width, height, now_ts);
+    Prepare(width, height, TimeUtil::NowTs());
+    RenderStatic(width, height);
+    RenderDynamic(width, height);
+}
+
+LayerChanges CalendarView::Prepare(int width, int height, int64_t now_ts) {
+    LayerChanges changes;
+    changes.static_layer = width != last_width_ || height != last_height_;
+    changes.dynamic_layer = UpdateCache(width, height, now_ts);
+    now_ts_ = now_ts;
+    return changes;
+}
+
+void CalendarView::RenderStatic(int width, int height) {
+    CalendarLayout layout = ComputeLayout(width, height);
 
-    std::tm now_tm = TimeUtil::LocalTime(now_ts);
+    SDL_Color line = { 200, 200, 200, 255 };
+
+    batch_.DrawRect(layout.panel, line);
+    batch_.DrawLine(layout.panel.x, layout.panel.y + layout.top_bar_h, layout.panel.x + layout.panel.w, layout.panel.y + layout.top_bar_h, line);
+
+    for (int row = 0; row < 6; ++row) {
+        for (int col = 0; col < 7; ++col) {
+            SDL_Rect cell{ layout.panel.x + col * layout.cell_w, layout.grid_y + row * layout.cell_h, layout.cell_w, layout.cell_h };
+            batch_.DrawRect(cell, line);
+        }
+    }
+
+    SDL_Rect agenda_rect{ layout.panel.x, layout.agenda_y, layout.panel.w, layout.agenda_h };
+    batch_.FillRect(agenda_rect, SDL_Color{ 248, 248, 248, 255 });
+    batch_.DrawLine(layout.panel.x, layout.agenda_y, layout.panel.x + layout.panel.w, layout.agenda_y, line);
+    batch_.Flush();
+}
+
+void CalendarView::RenderDynamic(int width, int height) {
+    std::tm now_tm = TimeUtil::LocalTime(now_ts_);
     std::tm sel_tm = TimeUtil::LocalTime(selected_ts_);
 
     int year = sel_tm.tm_year + 1900;
@@ -300,17 +280,13 @@ void CalendarView::Render(int width, int height) {
     SDL_Color accent = { 70, 70, 70, 255 };
     SDL_Color highlight = { 245, 245, 245, 255 };
 
-    SDL_SetRenderDrawColor(renderer_, line.r, line.g, line.b, 255);
-    SDL_RenderDrawRect(renderer_, &layout.panel);
-    SDL_RenderDrawLine(renderer_, layout.panel.x, layout.panel.y + layout.top_bar_h, layout.panel.x + layout.panel.w, layout.panel.y + layout.top_bar_h);
-
-    if (month_text_.texture) {
+    if (!month_text_.Empty()) {
         SDL_Rect dst{ layout.panel.x + 18, layout.panel.y + (layout.top_bar_h - month_text_.h) / 2, month_text_.w, month_text_.h };
-        SDL_RenderCopy(renderer_, month_text_.texture, nullptr, &dst);
+        text_->Draw(*month_text_.layout, dst, month_text_.color);
     }
-    if (sync_text_.texture) {
+    if (!sync_text_.Empty()) {
         SDL_Rect dst{ layout.panel.x + layout.panel.w - sync_text_.w - 18, layout.panel.y + (layout.top_bar_h - sync_text_.h) / 2, sync_text_.w, sync_text_.h };
-        SDL_RenderCopy(renderer_, sync_text_.texture, nullptr, &dst);
+        text_->Draw(*sync_text_.layout, dst, sync_text_.color);
     }
 
     int first_wday = TimeUtil::WeekdayIndex(year, month, 1);
@@ -322,8 +298,6 @@ void CalendarView::Render(int width, int height) {
             int cell_x = layout.panel.x + col * layout.cell_w;
             int cell_y = layout.grid_y + row * layout.cell_h;
             SDL_Rect cell{ cell_x, cell_y, layout.cell_w, layout.cell_h };
-            SDL_SetRenderDrawColor(renderer_, line.r, line.g, line.b, 255);
-            SDL_RenderDrawRect(renderer_, &cell);
 
             int index = row * 7 + col;
             if (index >= first_wday && day <= days_in_month) {
@@ -331,30 +305,26 @@ void CalendarView::Render(int width, int height) {
                 bool is_selected = (day == sel_tm.tm_mday && month == (sel_tm.tm_mon + 1) && year == (sel_tm.tm_year + 1900));
 
                 if (is_selected) {
-                    SDL_SetRenderDrawColor(renderer_, highlight.r, highlight.g, highlight.b, 255);
-                    SDL_RenderFillRect(renderer_, &cell);
-                    SDL_SetRenderDrawColor(renderer_, line.r, line.g, line.b, 255);
-                    SDL_RenderDrawRect(renderer_, &cell);
+                    batch_.FillRect(cell, highlight);
+                    batch_.DrawRect(cell, line);
                 }
 
                 if (is_today) {
-                    SDL_SetRenderDrawColor(renderer_, accent.r, accent.g, accent.b, 255);
-                    SDL_RenderDrawRect(renderer_, &cell);
+                    batch_.DrawRect(cell, accent);
                 }
 
                 if (day - 1 < static_cast<int>(day_texts_.size())) {
                     const auto& day_cache = day_texts_[day - 1];
-                    if (day_cache.texture) {
+                    if (!day_cache.Empty()) {
                         SDL_Rect dst{ cell_x + 7, cell_y + 5, day_cache.w, day_cache.h };
-                        SDL_RenderCopy(renderer_, day_cache.texture, nullptr, &dst);
+                        text_->Draw(*day_cache.layout, dst, day_cache.color);
                     }
                 }
 
                 auto it = event_days_cache_.find(day);
                 if (it != event_days_cache_.end()) {
-                    SDL_SetRenderDrawColor(renderer_, accent.r, accent.g, accent.b, 255);
                     SDL_Rect dot{ cell_x + layout.cell_w - 9, cell_y + layout.cell_h - 9, 4, 4 };
-                    SDL_RenderFillRect(renderer_, &dot);
+                    batch_.FillRect(dot, accent);
                 }
 
                 day++;
@@ -362,30 +332,28 @@ void CalendarView::Render(int width, int height) {
         }
     }
 
-    SDL_Rect agenda_rect{ layout.panel.x, layout.agenda_y, layout.panel.w, layout.agenda_h };
-    SDL_SetRenderDrawColor(renderer_, 248, 248, 248, 255);
-    SDL_RenderFillRect(renderer_, &agenda_rect);
-    SDL_SetRenderDrawColor(renderer_, line.r, line.g, line.b, 255);
-    SDL_RenderDrawLine(renderer_, layout.panel.x, layout.agenda_y, layout.panel.x + layout.panel.w, layout.agenda_y);
-
     int line_y = layout.agenda_y + 8;
-    if (agenda_title_.texture) {
+    if (!agenda_title_.Empty()) {
         SDL_Rect dst{ layout.panel.x + 18, line_y, agenda_title_.w, agenda_title_.h };
-        SDL_RenderCopy(renderer_, agenda_title_.texture, nullptr, &dst);
+        text_->Draw(*agenda_title_.layout, dst, agenda_title_.color);
         line_y += agenda_title_.h + 6;
     }
 
     for (const auto& line_cache : agenda_lines_) {
-        if (!line_cache.texture) {
+        if (line_cache.Empty()) {
             continue;
         }
         SDL_Rect dst{ layout.panel.x + 18, line_y, line_cache.w, line_cache.h };
-        SDL_RenderCopy(renderer_, line_cache.texture, nullptr, &dst);
+        text_->Draw(*line_cache.layout, dst, line_cache.color);
         line_y += line_cache.h + 6;
     }
 
-    if (remaining_count_ > 0 && more_text_.texture) {
+    if (remaining_count_ > 0 && !more_text_.Empty()) {
         SDL_Rect dst{ layout.panel.x + 18, line_y, more_text_.w, more_text_.h };
-        SDL_RenderCopy(renderer_, more_text_.texture, nullptr, &dst);
+        text_->Draw(*more_text_.layout, dst, more_text_.color);
     }
+
+    // Cell highlights go under the day numbers.
+    batch_.Flush();
+    text_->Flush();
 }
@@ -7,37 +7,44 @@
 #include <string>
 #include <vector>
 
-class EventStore;
+#include "render/FontRegistry.h"
+#include "render/LayeredView.h"
+#include "render/PrimitiveBatch.h"
+#include "render/TextCache.h"
+#include "render/TextRenderer.h"
 
-class CalendarView {
+class EventSnapshotSlot;
+class MetaSnapshotSlot;
+
+class CalendarView : public LayeredView {
 public:
-    CalendarView(SDL_Renderer* renderer, TTF_Font* header_font, TTF_Font* day_font, TTF_Font* agenda_font, EventStore* store);
-    ~CalendarView();
+    CalendarView(SDL_Renderer* renderer, TextRenderer* text, FontHandle header_font, FontHandle day_font, FontHandle agenda_font,
+                 const EventSnapshotSlot* events, const MetaSnapshotSlot* sync_status);
+    ~CalendarView() override;
 
     void Render(int width, int height);
+    LayerChanges Prepare(int width, int height, int64_t now_ts) override;
+    void RenderStatic(int width, int height) override;
+    void RenderDynamic(int width, int height) override;
+    // Forces the next Render to re-read the snapshots, e.g. after a sync finished.
+    void Invalidate();
     void MoveSelectionDays(int delta);
     void MoveMonth(int delta_months);
     void JumpToToday();
 
 private:
-    struct CachedText {
-        std::string text;
-        SDL_Texture* texture = nullptr;
-        int w = 0;
-        int h = 0;
-        SDL_Color color{ 0, 0, 0, 0 };
-    };
-
-    void UpdateCache(int width, int height, int64_t now_ts);
-    void UpdateText(CachedText& cache, TTF_Font* font, const std::string& text, SDL_Color color);
+    bool UpdateCache(int width, int height, int64_t now_ts);
     void ClearCache();
     void RebuildDayTextures(int days_in_month, SDL_Color color);
 
     SDL_Renderer* renderer_;
-    TTF_Font* header_font_;
-    TTF_Font* day_font_;
-    TTF_Font* agenda_font_;
-    EventStore* store_;
+    TextRenderer* text_;
+    PrimitiveBatch batch_;
+    FontHandle header_font_;
+    FontHandle day_font_;
+    FontHandle agenda_font_;
+    const EventSnapshotSlot* events_;
+    const MetaSnapshotSlot* sync_status_;
     int64_t selected_ts_;
 
     int last_width_ = 0;
@@ -46,6 +53,7 @@ private:
     int last_month_ = -1;
     int last_day_ = -1;
     int64_t last_minute_ = -1;
+    int64_t now_ts_ = 0;
 
     std::vector<CachedText> day_texts_;
     std::map<int, int> event_days_cache_;
@@ -1,6 +1,8 @@
 #include "views/ClockView.h"
 
-#include "db/EventStore.h"
+#include "db/EventSnapshot.h"
+#include "db/MetaSnapshot.h"
+#include "util/PerfCounters.h"
 #include "util/TimeUtil.h"
 
 #include <algorithm>
@@ -10,11 +12,11 @@
 #include <iomanip>
 #include <iostream>
 #include <locale>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
 
-#include <SDL_image.h>
 #include <nlohmann/json.hpp>
 
 namespace {
@@ -63,58 +65,23 @@ ClockLayout ComputeLayout(int width, int height) {
     return layout;
 }
 
-SDL_Texture* RenderText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, SDL_Color color, int* w, int* h) {
-    SDL_Surface* surface = TTF_RenderUTF8_Blended(font, text.c_str(), color);
-    if (!surface) {
-        std::cerr << "TTF_RenderUTF8_Blended failed: " << TTF_GetError() << "\n";
-        return nullptr;
-    }
-    SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!tex) {
-        std::cerr << "SDL_CreateTextureFromSurface failed: " << SDL_GetError() << "\n";
-        SDL_FreeSurface(surface);
-        return nullptr;
-    }
-    *w = surface->w;
-    *h = surface->h;
-    SDL_FreeSurface(surface);
-    return tex;
+void AddPixel(std::vector<SDL_Rect>* rects, int x, int y, int size) {
+    rects->push_back(SDL_Rect{ x - size / 2, y - size / 2, size, size });
 }
 
-std::string TruncateText(TTF_Font* font, const std::string& text, int max_width) {
-    int w = 0;
-    int h = 0;
-    if (TTF_SizeUTF8(font, text.c_str(), &w, &h) == 0 && w <= max_width) {
-        return text;
-    }
-    const std::string ellipsis = "...";
-    for (size_t len = text.size(); len > 0; --len) {
-        std::string candidate = text.substr(0, len) + ellipsis;
-        if (TTF_SizeUTF8(font, candidate.c_str(), &w, &h) == 0 && w <= max_width) {
-            return candidate;
-        }
-    }
-    return ellipsis;
-}
-
-void DrawPixel(SDL_Renderer* renderer, int x, int y, int size) {
-    SDL_Rect rect{ x - size / 2, y - size / 2, size, size };
-    SDL_RenderFillRect(renderer, &rect);
-}
-
-void DrawPixelCircle(SDL_Renderer* renderer, int cx, int cy, int radius, int pixel) {
+void AddPixelCircle(std::vector<SDL_Rect>* rects, int cx, int cy, int radius, int pixel) {
     int x = radius;
     int y = 0;
     int err = 0;
     while (x >= y) {
-        DrawPixel(renderer, cx + x, cy + y, pixel);
-        DrawPixel(renderer, cx + y, cy + x, pixel);
-        DrawPixel(renderer, cx - y, cy + x, pixel);
-        DrawPixel(renderer, cx - x, cy + y, pixel);
-        DrawPixel(renderer, cx - x, cy - y, pixel);
-        DrawPixel(renderer, cx - y, cy - x, pixel);
-        DrawPixel(renderer, cx + y, cy - x, pixel);
-        DrawPixel(renderer, cx + x, cy - y, pixel);
+        AddPixel(rects, cx + x, cy + y, pixel);
+        AddPixel(rects, cx + y, cy + x, pixel);
+        AddPixel(rects, cx - y, cy + x, pixel);
+        AddPixel(rects, cx - x, cy + y, pixel);
+        AddPixel(rects, cx - x, cy - y, pixel);
+        AddPixel(rects, cx - y, cy - x, pixel);
+        AddPixel(rects, cx + y, cy - x, pixel);
+        AddPixel(rects, cx + x, cy - y, pixel);
         if (err <= 0) {
             ++y;
             err += 2 * y + 1;
@@ -126,7 +93,7 @@ void DrawPixelCircle(SDL_Renderer* renderer, int cx, int cy, int radius, int pix
     }
 }
 
-void DrawPixelLine(SDL_Renderer* renderer, int x0, int y0, int x1, int y1, int pixel) {
+void AddPixelLine(std::vector<SDL_Rect>* rects, int x0, int y0, int x1, int y1, int pixel) {
     int dx = std::abs(x1 - x0);
     int dy = std::abs(y1 - y0);
     int steps = std::max(dx, dy) / std::max(1, pixel);
@@ -136,36 +103,43 @@ void DrawPixelLine(SDL_Renderer* renderer, int x0, int y0, int x1, int y1, int p
     for (int i = 0; i <= steps; ++i) {
         int x = x0 + (x1 - x0) * i / steps;
         int y = y0 + (y1 - y0) * i / steps;
-        DrawPixel(renderer, x, y, pixel);
+        AddPixel(rects, x, y, pixel);
     }
 }
 
-void DrawClockIcon(SDL_Renderer* renderer, int cx, int cy, int radius, int hour, int minute, int second) {
+int ClockIconPixel(int radius) {
+    return std::max(2, radius / 10);
+}
+
+// The pixel-art clock used when the sprites are missing, as rects for one
+// SDL_RenderFillRects call. `rects` keeps its capacity between calls.
+void BuildClockIcon(std::vector<SDL_Rect>* rects, int cx, int cy, int radius, int hour, int minute) {
     constexpr double kPi = 3.14159265358979323846;
-    int pixel = std::max(2, radius / 10);
-    DrawPixelCircle(renderer, cx, cy, radius, pixel);
-    double minute_angle = (minute + second / 60.0) * 6.0;
+    rects->clear();
+    int pixel = ClockIconPixel(radius);
+    AddPixelCircle(rects, cx, cy, radius, pixel);
+    double minute_angle = minute * 6.0;
     double hour_angle = ((hour % 12) + minute / 60.0) * 30.0;
 
-    auto draw_hand = [&](double angle_deg, int length) {
+    auto add_hand = [&](double angle_deg, int length) {
         double rad = (angle_deg - 90.0) * kPi / 180.0;
         int x = static_cast<int>(std::round(cx + std::cos(rad) * length));
         int y = static_cast<int>(std::round(cy + std::sin(rad) * length));
-        DrawPixelLine(renderer, cx, cy, x, y, pixel);
+        AddPixelLine(rects, cx, cy, x, y, pixel);
     };
 
-    draw_hand(hour_angle, radius - 10);
-    draw_hand(minute_angle, radius - 4);
-    DrawPixel(renderer, cx, cy, pixel + 1);
+    add_hand(hour_angle, radius - 10);
+    add_hand(minute_angle, radius - 4);
+    AddPixel(rects, cx, cy, pixel + 1);
 }
 
-std::string SyncStatusLabel(EventStore* store, int64_t now_ts) {
-    if (!store) {
+std::string SyncStatusLabel(const MetaSnapshot* meta, int64_t now_ts) {
+    if (!meta) {
         return "Offline";
     }
-    std::string status = store->GetMeta("last_sync_status");
-    std::string ts_str = store->GetMeta("last_sync_ts");
-    std::string err = store->GetMeta("last_sync_error");
+    const std::string& status = meta->Get("last_sync_status");
+    const std::string& ts_str = meta->Get("last_sync_ts");
+    const std::string& err = meta->Get("last_sync_error");
     std::string label = status.empty() ? "Offline" : status;
     if (label == "online") {
         label = "Online";
@@ -207,14 +181,14 @@ std::string SyncStatusLabel(EventStore* store, int64_t now_ts) {
     return label + " (" + std::to_string(minutes) + "m)";
 }
 
-std::string WeatherSummaryLine(EventStore* store) {
-    if (!store) {
+std::string WeatherSummaryLine(const MetaSnapshot* meta) {
+    if (!meta) {
         return "Weather unavailable";
     }
 
-    std::string status = store->GetMeta("weather_status");
-    std::string temp_c = store->GetMeta("weather_temp_c");
-    std::string summary = store->GetMeta("weather_summary");
+    const std::string& status = meta->Get("weather_status");
+    const std::string& temp_c = meta->Get("weather_temp_c");
+    const std::string& summary = meta->Get("weather_summary");
 
     if (status == "disabled") {
         return "Weather off";
@@ -249,11 +223,11 @@ std::string FormatDecimal1(double value) {
     return out.str();
 }
 
-std::string WeatherHighLow(EventStore* store) {
-    if (!store) {
+std::string WeatherHighLow(const MetaSnapshot* meta) {
+    if (!meta) {
         return "";
     }
-    std::string daily_json = store->GetMeta("weather_daily_json");
+    const std::string& daily_json = meta->Get("weather_daily_json");
     if (daily_json.empty()) {
         return "";
     }
@@ -271,17 +245,6 @@ std::string WeatherHighLow(EventStore* store) {
     return "H " + FormatDecimal1(max_c) + " C  L " + FormatDecimal1(min_c) + " C";
 }
 
-std::string JoinPath(const std::string& dir, const std::string& file) {
-    if (dir.empty()) {
-        return file;
-    }
-    char last = dir.back();
-    if (last == '/' || last == '\\') {
-        return dir + file;
-    }
-    return dir + "/" + file;
-}
-
 std::string FormatCountdown(int total_minutes) {
     if (total_minutes <= 0) {
         return "now";
@@ -296,107 +259,60 @@ std::string FormatCountdown(int total_minutes) {
 
 } // namespace
 
-ClockView::ClockView(SDL_Renderer* renderer, TTF_Font* time_font, TTF_Font* date_font, TTF_Font* info_font, EventStore* store, const std::string& sprite_dir)
-    : renderer_(renderer), time_font_(time_font), date_font_(date_font), info_font_(info_font), store_(store), sprite_dir_(sprite_dir) {
+ClockView::ClockView(SDL_Renderer* renderer, TextRenderer* text, FontHandle time_font, FontHandle date_font, FontHandle info_font,
+                     const EventSnapshotSlot* events, const MetaSnapshotSlot* sync_status, const MetaSnapshotSlot* weather,
+                     const std::string& sprite_dir, AssetLoader* assets)
+    : renderer_(renderer), text_(text), batch_(renderer), time_font_(time_font), date_font_(date_font), info_font_(info_font), events_(events), sync_status_(sync_status), weather_(weather), sprite_dir_(sprite_dir), assets_(assets), sprites_(renderer) {
     LoadSprites();
 }
 
 ClockView::~ClockView() {
     ClearCache();
     ClearSprites();
-}
-
-void ClockView::UpdateText(CachedText& cache, TTF_Font* font, const std::string& text, SDL_Color color) {
-    if (text.empty()) {
-        if (cache.texture) {
-            SDL_DestroyTexture(cache.texture);
-            cache.texture = nullptr;
-        }
-        cache.text.clear();
-        cache.w = 0;
-        cache.h = 0;
-        cache.color = color;
-        return;
+    if (clock_icon_) {
+        SDL_DestroyTexture(clock_icon_);
+        clock_icon_ = nullptr;
     }
-    if (cache.texture && cache.text == text && cache.color.r == color.r && cache.color.g == color.g && cache.color.b == color.b && cache.color.a == color.a) {
-        return;
-    }
-    if (cache.texture) {
-        SDL_DestroyTexture(cache.texture);
-        cache.texture = nullptr;
-    }
-    cache.text = text;
-    cache.color = color;
-    cache.texture = RenderText(renderer_, font, text, color, &cache.w, &cache.h);
 }
 
 void ClockView::ClearCache() {
-    auto destroy = [](CachedText& cache) {
-        if (cache.texture) {
-            SDL_DestroyTexture(cache.texture);
-            cache.texture = nullptr;
-        }
+    auto clear = [](CachedText& cache) {
+        cache.Clear();
     };
-    destroy(time_text_);
-    destroy(ampm_text_);
-    destroy(date_text_);
-    destroy(footer_text_);
+    time_layout_.Clear();
+    ampm_layout_ = nullptr;
+    last_time_key_ = -1;
+    clear(date_text_);
+    clear(footer_text_);
     for (auto& item : right_texts_) {
-        destroy(item);
+        clear(item);
     }
     for (auto& item : cell_labels_) {
-        destroy(item);
+        clear(item);
     }
     for (auto& item : cell_values_) {
-        destroy(item);
+        clear(item);
     }
 }
 
 void ClockView::LoadSprites() {
-    sprites_loaded_ = false;
+    sprites_.Clear();
     if (sprite_dir_.empty()) {
         return;
     }
-
-    std::array<std::string, static_cast<size_t>(SpriteKind::Count)> names = {
+    // Same order as SpriteKind.
+    static const std::vector<std::string> kFiles = {
         "Midnight.png",
         "Sunrise.png",
         "Sun.png",
         "Sunset.png",
         "Moon.png"
     };
-
-    for (size_t i = 0; i < names.size(); ++i) {
-        std::string path = JoinPath(sprite_dir_, names[i]);
-        SDL_Surface* surface = IMG_Load(path.c_str());
-        if (!surface) {
-            std::cerr << "Sprite load failed: " << path << " - " << IMG_GetError() << "\n";
-            continue;
-        }
-        SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer_, surface);
-        if (!tex) {
-            std::cerr << "Sprite texture failed: " << path << " - " << SDL_GetError() << "\n";
-            SDL_FreeSurface(surface);
-            continue;
-        }
-        sprites_[i].texture = tex;
-        sprites_[i].w = surface->w;
-        sprites_[i].h = surface->h;
-        SDL_FreeSurface(surface);
-        sprites_loaded_ = true;
-    }
+    sprites_.LoadAsync(assets_, sprite_dir_, kFiles);
 }
 
 void ClockView::ClearSprites() {
-    for (auto& sprite : sprites_) {
-        if (sprite.texture) {
-            SDL_DestroyTexture(sprite.texture);
-            sprite.texture = nullptr;
-        }
-        sprite.w = 0;
-        sprite.h = 0;
-    }
-    sprites_loaded_ = false;
+    sprites_.Clear();
 }
 
 ClockView::SpriteKind ClockView::SpriteForHour(int hour) const {
@@ -416,58 +332,92 @@ ClockView::SpriteKind ClockView::SpriteForHour(int hour) const {
 }
 
 bool ClockView::DrawSpriteForHour(int hour, const SDL_Rect& area) {
-    if (!sprites_loaded_) {
-        return false;
-    }
-    SpriteKind kind = SpriteForHour(hour);
-    const auto& sprite = sprites_[static_cast<size_t>(kind)];
-    if (!sprite.texture || sprite.w <= 0 || sprite.h <= 0) {
-        return false;
-    }
-
     int pad = std::max(10, area.w / 8);
-    int max_w = area.w - pad * 2;
-    int max_h = area.h - pad * 2;
-    if (max_w <= 0 || max_h <= 0) {
+    SDL_Rect inner{ area.x + pad, area.y + pad, area.w - pad * 2, area.h - pad * 2 };
+    if (inner.w <= 0 || inner.h <= 0) {
         return false;
     }
+    return sprites_.DrawFit(static_cast<size_t>(SpriteForHour(hour)), inner);
+}
 
-    float scale = std::min(static_cast<float>(max_w) / sprite.w, static_cast<float>(max_h) / sprite.h);
-    int draw_w = static_cast<int>(std::round(sprite.w * scale));
-    int draw_h = static_cast<int>(std::round(sprite.h * scale));
+void ClockView::DrawClockIcon(int cx, int cy, int radius, int hour, int minute, SDL_Color color) {
+    if (radius <= 0) {
+        return;
+    }
+    if (SDL_RenderTargetSupported(renderer_) != SDL_TRUE) {
+        BuildClockIcon(&clock_icon_rects_, cx, cy, radius, hour, minute);
+        for (const SDL_Rect& rect : clock_icon_rects_) {
+            batch_.FillRect(rect, color);
+        }
+        return;
+    }
 
-    SDL_Rect dst{
-        area.x + (area.w - draw_w) / 2,
-        area.y + (area.h - draw_h) / 2,
-        draw_w,
-        draw_h
-    };
-    SDL_RenderCopy(renderer_, sprite.texture, nullptr, &dst);
-    return true;
+    // The icon covers the circle plus half a pixel block on each side.
+    int half = radius + ClockIconPixel(radius);
+    int size = half * 2 + 1;
+    if (!clock_icon_ || size != clock_icon_size_) {
+        if (clock_icon_) {
+            SDL_DestroyTexture(clock_icon_);
+        }
+        clock_icon_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, size, size);
+        if (!clock_icon_) {
+            std::cerr << "SDL_CreateTexture (clock icon) failed: " << SDL_GetError() << "\n";
+            clock_icon_size_ = 0;
+            return;
+        }
+        SDL_SetTextureBlendMode(clock_icon_, SDL_BLENDMODE_BLEND);
+        PerfCounters::AddTextureCreated(static_cast<size_t>(size) * size * 4);
+        clock_icon_size_ = size;
+        clock_icon_key_ = -1;
+    }
+
+    int key = hour * 60 + minute;
+    if (key != clock_icon_key_) {
+        BuildClockIcon(&clock_icon_rects_, half, half, radius, hour, minute);
+        SDL_Texture* previous_target = SDL_GetRenderTarget(renderer_);
+        if (SDL_SetRenderTarget(renderer_, clock_icon_) != 0) {
+            std::cerr << "SDL_SetRenderTarget failed: " << SDL_GetError() << "\n";
+            SDL_SetRenderTarget(renderer_, previous_target);
+            return;
+        }
+        SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 0);
+        SDL_RenderClear(renderer_);
+        SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
+        SDL_RenderFillRects(renderer_, clock_icon_rects_.data(), static_cast<int>(clock_icon_rects_.size()));
+        PerfCounters::AddDrawCall();
+        SDL_SetRenderTarget(renderer_, previous_target);
+        clock_icon_key_ = key;
+    }
+
+    SDL_Rect dst{ cx - half, cy - half, size, size };
+    SDL_RenderCopy(renderer_, clock_icon_, nullptr, &dst);
+    PerfCounters::AddDrawCall();
 }
 
-void ClockView::UpdateCache(int width, int height, int64_t now_ts) {
+bool ClockView::UpdateCache(int width, int height, int64_t now_ts) {
     int64_t minute = now_ts / 60;
     bool size_changed = width != last_width_ || height != last_height_;
     if (minute == last_minute_ && !size_changed) {
-        return;
+        return false;
     }
     last_minute_ = minute;
     last_width_ = width;
     last_height_ = height;
+    if (size_changed) {
+        sprites_.ClearScaled();
+    }
 
     ClockLayout layout = ComputeLayout(width, height);
 
     SDL_Color fg = { 28, 28, 28, 255 };
     SDL_Color dim = { 110, 110, 110, 255 };
 
-    UpdateText(time_text_, time_font_, TimeUtil::FormatTimeHHMMNoSuffix(now_ts), fg);
-    UpdateText(ampm_text_, info_font_, TimeUtil::FormatAmPm(now_ts), dim);
-    UpdateText(date_text_, date_font_, TimeUtil::FormatDateLine(now_ts), dim);
+    text_->Cache().Update(&date_text_, date_font_.Get(), TimeUtil::FormatDateLine(now_ts), dim);
 
+    std::shared_ptr<const EventSnapshot> events = events_ ? events_->Current() : nullptr;
     std::string next_line;
     EventRecord next_event;
-    bool has_next = store_ && store_->GetNextEventAfter(now_ts, &next_event);
+    bool has_next = events && events->NextEventAfter(now_ts, &next_event);
     if (has_next && next_event.start_ts <= TimeUtil::EndOfDay(now_ts)) {
         int minutes = static_cast<int>((next_event.start_ts - now_ts) / 60);
         if (minutes < 0) {
@@ -478,10 +428,10 @@ void ClockView::UpdateCache(int width, int height, int64_t now_ts) {
     } else {
         next_line = "Next: No upcoming events";
     }
-    std::string footer_text = TruncateText(info_font_, next_line, layout.footer_max_w);
-    UpdateText(footer_text_, info_font_, footer_text, dim);
+    std::string footer_text = text_->Measure().Truncate(info_font_.Get(), next_line, layout.footer_max_w);
+    text_->Cache().Update(&footer_text_, info_font_.Get(), footer_text, dim);
 
-    std::vector<EventRecord> today_events = store_ ? store_->GetEventsForDay(now_ts) : std::vector<EventRecord>();
+    std::vector<EventRecord> today_events = events ? events->EventsForDay(now_ts) : std::vector<EventRecord>();
     int all_day_today = 0;
     int remaining_today = 0;
     for (const auto& ev : today_events) {
@@ -504,12 +454,13 @@ void ClockView::UpdateCache(int width, int height, int64_t now_ts) {
     } else {
         next_summary = "Next: No upcoming events";
     }
-    next_summary = TruncateText(info_font_, next_summary, layout.right_max_w);
+    next_summary = text_->Measure().Truncate(info_font_.Get(), next_summary, layout.right_max_w);
 
     int bottom_cell_max_w = std::max(100, layout.panel.w / 2 - 36);
-    std::string weather_status = store_ ? store_->GetMeta("weather_status") : "";
-    std::string weather_temp = store_ ? store_->GetMeta("weather_temp_c") : "";
-    std::string weather_desc = store_ ? store_->GetMeta("weather_summary") : "";
+    std::shared_ptr<const MetaSnapshot> weather = weather_ ? weather_->Current() : nullptr;
+    std::string weather_status = weather ? weather->Get("weather_status") : "";
+    std::string weather_temp = weather ? weather->Get("weather_temp_c") : "";
+    std::string weather_desc = weather ? weather->Get("weather_summary") : "";
     std::string weather_main;
     if (!weather_temp.empty()) {
         weather_main = weather_temp + " C";
@@ -525,24 +476,25 @@ void ClockView::UpdateCache(int width, int height, int64_t now_ts) {
     } else if (weather_status == "offline") {
         weather_main += " (cached)";
     }
-    std::string weather_summary = TruncateText(date_font_, weather_main, bottom_cell_max_w);
-    std::string weather_hilo = TruncateText(info_font_, WeatherHighLow(store_), bottom_cell_max_w);
+    std::string weather_summary = text_->Measure().Truncate(date_font_.Get(), weather_main, bottom_cell_max_w);
+    std::string weather_hilo = text_->Measure().Truncate(info_font_.Get(), WeatherHighLow(weather.get()), bottom_cell_max_w);
 
     std::string today_summary = (today_events.size() > 0)
         ? ("Today: " + std::to_string(static_cast<int>(today_events.size())) + " events")
         : "Today: Free";
-    today_summary = TruncateText(info_font_, today_summary, layout.right_max_w);
+    today_summary = text_->Measure().Truncate(info_font_.Get(), today_summary, layout.right_max_w);
 
+    std::shared_ptr<const MetaSnapshot> sync_status = sync_status_ ? sync_status_->Current() : nullptr;
     std::array<std::string, 4> right_lines = {
         next_summary,
         today_summary,
-        SyncStatusLabel(store_, now_ts),
+        SyncStatusLabel(sync_status.get(), now_ts),
         ""
     };
 
     for (size_t i = 0; i < right_lines.size(); ++i) {
         SDL_Color color = (i == 0) ? fg : dim;
-        UpdateText(right_texts_[i], info_font_, right_lines[i], color);
+        text_->Cache().Update(&right_texts_[i], info_font_.Get(), right_lines[i], color);
     }
 
     std::array<std::string, 4> labels = {
@@ -552,7 +504,7 @@ void ClockView::UpdateCache(int width, int height, int64_t now_ts) {
         (remaining_today > 0) ? "Remaining" : ""
     };
     std::array<std::string, 4> values = {
-        TruncateText(info_font_, (today_events.size() > 0) ? (std::to_string(static_cast<int>(today_events.size())) + " events") : "Free", bottom_cell_max_w),
+        text_->Measure().Truncate(info_font_.Get(), (today_events.size() > 0) ? (std::to_string(static_cast<int>(today_events.size())) + " events") : "Free", bottom_cell_max_w),
         weather_hilo,
         (all_day_today > 0) ? (std::to_string(all_day_today) + " today") : "",
         (remaining_today > 0) ? (std::to_string(remaining_today) + " today") : ""
@@ -560,72 +512,216 @@ void ClockView::UpdateCache(int width, int height, int64_t now_ts) {
 
     for (size_t i = 0; i < labels.size(); ++i) {
         if (i == 1) {
-            UpdateText(cell_labels_[i], date_font_, labels[i], fg);
-            UpdateText(cell_values_[i], info_font_, values[i], dim);
+            text_->Cache().Update(&cell_labels_[i], date_font_.Get(), labels[i], fg);
+            text_->Cache().Update(&cell_values_[i], info_font_.Get(), values[i], dim);
         } else {
-            UpdateText(cell_labels_[i], info_font_, labels[i], dim);
-            UpdateText(cell_values_[i], info_font_, values[i], fg);
+            text_->Cache().Update(&cell_labels_[i], info_font_.Get(), labels[i], dim);
+            text_->Cache().Update(&cell_values_[i], info_font_.Get(), values[i], fg);
+        }
+    }
+    return true;
+}
+
+void ClockView::Invalidate() {
+    last_minute_ = -1;
+}
+
+void ClockView::OnRenderReset(bool device_lost) {
+    // The icon is a render target, so its pixels are gone either way.
+    clock_icon_key_ = -1;
+    if (device_lost) {
+        if (clock_icon_) {
+            SDL_DestroyTexture(clock_icon_);
+            clock_icon_ = nullptr;
+            clock_icon_size_ = 0;
         }
+        sprites_.RecreateTextures();
     }
 }
 
+void ClockView::SetSecondsMode(bool show_seconds, bool blink_colon) {
+    show_seconds_ = show_seconds;
+    blink_colon_ = blink_colon;
+    last_time_key_ = -1;
+}
+
+bool ClockView::EnsureTimeGlyphs() {
+    TTF_Font* font = time_font_.Get();
+    TTF_Font* suffix_font = info_font_.Get();
+    if (!font) {
+        return false;
+    }
+    TimeGlyphs& glyphs = time_glyphs_;
+    if (glyphs.font == font && glyphs.suffix_font == suffix_font && glyphs.generation == text_->Generation()) {
+        return true;
+    }
+    glyphs.font = font;
+    glyphs.suffix_font = suffix_font;
+    static const char kChars[] = "0123456789:";
+    // A layout late in the set may clear a full atlas, leaving the earlier
+    // ones pointing at slots that are gone, so lay the set out again until
+    // one pass completes within a single generation. If it never fits, the
+    // set keeps the generation it started from: Draw treats it as stale and
+    // the next call tries again.
+    constexpr int kMaxPasses = 2;
+    uint32_t generation = 0;
+    for (int pass = 0; pass < kMaxPasses; ++pass) {
+        generation = text_->Generation();
+        glyphs.digit_w = 0;
+        for (size_t i = 0; i < glyphs.chars.size(); ++i) {
+            text_->Layout(font, std::string(1, kChars[i]), &glyphs.chars[i]);
+            if (i < 10) {
+                glyphs.digit_w = std::max(glyphs.digit_w, glyphs.chars[i].w);
+            }
+        }
+        text_->Layout(suffix_font, "AM", &glyphs.am);
+        text_->Layout(suffix_font, "PM", &glyphs.pm);
+        if (text_->Generation() == generation) {
+            break;
+        }
+    }
+    glyphs.generation = generation;
+    last_time_key_ = -1;
+    return true;
+}
+
+bool ClockView::UpdateTime(int64_t now_ts) {
+    if (!EnsureTimeGlyphs()) {
+        bool had_time = !time_layout_.Empty();
+        time_layout_.Clear();
+        ampm_layout_ = nullptr;
+        return had_time;
+    }
+    std::tm tm = TimeUtil::LocalTime(now_ts);
+    int second = TicksEverySecond() ? tm.tm_sec : 0;
+    int64_t key = (static_cast<int64_t>(tm.tm_hour) * 60 + tm.tm_min) * 60 + second;
+    if (key == last_time_key_) {
+        return false;
+    }
+    last_time_key_ = key;
+
+    const TimeGlyphs& glyphs = time_glyphs_;
+    time_layout_.Clear();
+    time_layout_.font = glyphs.font;
+    time_layout_.generation = glyphs.generation;
+    int pen = 0;
+    auto append = [&](int index, bool visible) {
+        const TextLayout& ch = glyphs.chars[static_cast<size_t>(index)];
+        int cell_w = index < 10 ? glyphs.digit_w : ch.w;
+        if (visible) {
+            int offset = pen + (cell_w - ch.w) / 2;
+            for (const auto& glyph : ch.glyphs) {
+                TextLayout::Glyph placed = glyph;
+                placed.x += offset;
+                time_layout_.glyphs.push_back(placed);
+            }
+        }
+        time_layout_.h = std::max(time_layout_.h, ch.h);
+        pen += cell_w;
+    };
+    // A hidden colon keeps its cell, so blinking does not move the digits.
+    bool colon_visible = !blink_colon_ || second % 2 == 0;
+
+    int hour12 = tm.tm_hour % 12;
+    if (hour12 == 0) {
+        hour12 = 12;
+    }
+    if (hour12 >= 10) {
+        append(hour12 / 10, true);
+    }
+    append(hour12 % 10, true);
+    append(10, colon_visible);
+    append(tm.tm_min / 10, true);
+    append(tm.tm_min % 10, true);
+    if (show_seconds_) {
+        append(10, colon_visible);
+        append(second / 10, true);
+        append(second % 10, true);
+    }
+    time_layout_.w = pen;
+    ampm_layout_ = tm.tm_hour < 12 ? &glyphs.am : &glyphs.pm;
+    return true;
+}
+
 void ClockView::Render(int width, int height) {
-    int64_t now_ts = TimeUtil::NowTs();
-    UpdateCache(width, height, now_ts);
+    Prepare(width, height, TimeUtil::NowTs());
+    RenderStatic(width, height);
+    RenderDynamic(width, height);
+}
 
+LayerChanges ClockView::Prepare(int width, int height, int64_t now_ts) {
+    LayerChanges changes;
+    changes.static_layer = width != last_width_ || height != last_height_;
+    changes.dynamic_layer = UpdateCache(width, height, now_ts);
+    changes.dynamic_layer = UpdateTime(now_ts) || changes.dynamic_layer;
+    // Sprites finishing their background decode replace the fallback icon.
+    changes.dynamic_layer = sprites_.Poll() || changes.dynamic_layer;
+    now_ts_ = now_ts;
+    return changes;
+}
+
+void ClockView::RenderStatic(int width, int height) {
     ClockLayout layout = ComputeLayout(width, height);
 
     SDL_Color line = { 200, 200, 200, 255 };
 
-    SDL_SetRenderDrawColor(renderer_, line.r, line.g, line.b, 255);
-    SDL_RenderDrawRect(renderer_, &layout.panel);
-    SDL_RenderDrawLine(renderer_, layout.panel.x, layout.divider_y, layout.panel.x + layout.panel.w, layout.divider_y);
-    SDL_RenderDrawLine(renderer_, layout.panel.x + layout.left_w, layout.top_y, layout.panel.x + layout.left_w, layout.divider_y);
-    SDL_RenderDrawLine(renderer_, layout.panel.x + layout.left_w + layout.center_w, layout.top_y, layout.panel.x + layout.left_w + layout.center_w, layout.divider_y);
+    batch_.DrawRect(layout.panel, line);
+    batch_.DrawLine(layout.panel.x, layout.divider_y, layout.panel.x + layout.panel.w, layout.divider_y, line);
+    batch_.DrawLine(layout.panel.x + layout.left_w, layout.top_y, layout.panel.x + layout.left_w, layout.divider_y, line);
+    batch_.DrawLine(layout.panel.x + layout.left_w + layout.center_w, layout.top_y, layout.panel.x + layout.left_w + layout.center_w, layout.divider_y, line);
+    batch_.Flush();
+}
+
+void ClockView::RenderDynamic(int width, int height) {
+    ClockLayout layout = ComputeLayout(width, height);
+
+    SDL_Color line = { 200, 200, 200, 255 };
 
-    std::tm now_tm = TimeUtil::LocalTime(now_ts);
+    std::tm now_tm = TimeUtil::LocalTime(now_ts_);
     SDL_Rect left_area{ layout.panel.x, layout.top_y, layout.left_w, layout.top_h };
     if (!DrawSpriteForHour(now_tm.tm_hour, left_area)) {
         int icon_cx = layout.panel.x + layout.left_w / 2;
         int icon_cy = layout.top_y + layout.top_h / 2;
         int radius = std::min(layout.left_w, layout.top_h) / 4;
-        DrawClockIcon(renderer_, icon_cx, icon_cy, radius, now_tm.tm_hour, now_tm.tm_min, now_tm.tm_sec);
+        DrawClockIcon(icon_cx, icon_cy, radius, now_tm.tm_hour, now_tm.tm_min, line);
     }
 
-    if (date_text_.texture) {
+    if (!date_text_.Empty()) {
         int date_x = layout.panel.x + layout.left_w + (layout.center_w - date_text_.w) / 2;
         int date_y = layout.top_y + 14;
         SDL_Rect dst{ date_x, date_y, date_text_.w, date_text_.h };
-        SDL_RenderCopy(renderer_, date_text_.texture, nullptr, &dst);
-    }
-
-    if (time_text_.texture) {
-        int time_x = layout.panel.x + layout.left_w + (layout.center_w - time_text_.w) / 2;
-        int time_y = layout.top_y + (layout.top_h - time_text_.h) / 2 + 6;
-        SDL_Rect dst{ time_x, time_y, time_text_.w, time_text_.h };
-        SDL_RenderCopy(renderer_, time_text_.texture, nullptr, &dst);
-        if (ampm_text_.texture) {
-            int ampm_x = time_x + time_text_.w + 8;
+        text_->Draw(*date_text_.layout, dst, date_text_.color);
+    }
+
+    if (!time_layout_.Empty()) {
+        SDL_Color fg = { 28, 28, 28, 255 };
+        SDL_Color dim = { 110, 110, 110, 255 };
+        int time_x = layout.panel.x + layout.left_w + (layout.center_w - time_layout_.w) / 2;
+        int time_y = layout.top_y + (layout.top_h - time_layout_.h) / 2 + 6;
+        SDL_Rect dst{ time_x, time_y, time_layout_.w, time_layout_.h };
+        text_->Draw(time_layout_, dst, fg);
+        if (ampm_layout_ && !ampm_layout_->Empty()) {
+            int ampm_x = time_x + time_layout_.w + 8;
             int ampm_y = time_y + 6;
-            SDL_Rect ampm_dst{ ampm_x, ampm_y, ampm_text_.w, ampm_text_.h };
-            SDL_RenderCopy(renderer_, ampm_text_.texture, nullptr, &ampm_dst);
+            SDL_Rect ampm_dst{ ampm_x, ampm_y, ampm_layout_->w, ampm_layout_->h };
+            text_->Draw(*ampm_layout_, ampm_dst, dim);
         }
     }
 
     int line_y = layout.right_y;
     for (const auto& item : right_texts_) {
-        if (!item.texture) {
+        if (item.Empty()) {
             continue;
         }
         SDL_Rect dst{ layout.right_x, line_y, item.w, item.h };
-        SDL_RenderCopy(renderer_, item.texture, nullptr, &dst);
+        text_->Draw(*item.layout, dst, item.color);
         line_y += item.h + 8;
     }
 
     std::array<int, 4> visible{};
     int visible_count = 0;
     for (int i = 0; i < 4; ++i) {
-        if (cell_labels_[i].texture || cell_values_[i].texture) {
+        if (!cell_labels_[i].Empty() || !cell_values_[i].Empty()) {
             visible[visible_count++] = i;
         }
     }
@@ -640,27 +736,26 @@ void ClockView::Render(int width, int height) {
     int row_h = layout.grid_h / cell_rows;
     int col_w = layout.panel.w / cell_cols;
 
-    SDL_SetRenderDrawColor(renderer_, line.r, line.g, line.b, 255);
     if (cell_cols == 2) {
-        SDL_RenderDrawLine(renderer_, layout.panel.x + col_w, layout.grid_y, layout.panel.x + col_w, layout.grid_y + layout.grid_h);
+        batch_.DrawLine(layout.panel.x + col_w, layout.grid_y, layout.panel.x + col_w, layout.grid_y + layout.grid_h, line);
     }
     if (cell_rows == 2) {
-        SDL_RenderDrawLine(renderer_, layout.panel.x, layout.grid_y + row_h, layout.panel.x + layout.panel.w, layout.grid_y + row_h);
+        batch_.DrawLine(layout.panel.x, layout.grid_y + row_h, layout.panel.x + layout.panel.w, layout.grid_y + row_h, line);
     }
 
     auto draw_cell = [&](int col, int row, const CachedText& label, const CachedText& value) {
-        if (!label.texture && !value.texture) {
+        if (label.Empty() && value.Empty()) {
             return;
         }
         int cell_x = layout.panel.x + col * col_w + 18;
         int cell_y = layout.grid_y + row * row_h + 8;
-        if (label.texture) {
+        if (!label.Empty()) {
             SDL_Rect dst{ cell_x, cell_y, label.w, label.h };
-            SDL_RenderCopy(renderer_, label.texture, nullptr, &dst);
+            text_->Draw(*label.layout, dst, label.color);
         }
-        if (value.texture) {
+        if (!value.Empty()) {
             SDL_Rect dst{ cell_x, cell_y + label.h + 6, value.w, value.h };
-            SDL_RenderCopy(renderer_, value.texture, nullptr, &dst);
+            text_->Draw(*value.layout, dst, value.color);
         }
     };
 
@@ -676,8 +771,11 @@ void ClockView::Render(int width, int height) {
         draw_cell(1, 1, cell_labels_[3], cell_values_[3]);
     }
 
-    if (footer_text_.texture) {
+    if (!footer_text_.Empty()) {
         SDL_Rect dst{ layout.panel.x + 16, layout.panel.y + layout.panel.h - footer_text_.h - 6, footer_text_.w, footer_text_.h };
-        SDL_RenderCopy(renderer_, footer_text_.texture, nullptr, &dst);
+        text_->Draw(*footer_text_.layout, dst, footer_text_.color);
     }
+
+    batch_.Flush();
+    text_->Flush();
 }
@@ -7,13 +7,34 @@
 #include <string>
 #include <vector>
 
-class EventStore;
+#include "render/FontRegistry.h"
+#include "render/LayeredView.h"
+#include "render/PrimitiveBatch.h"
+#include "render/SpriteAtlas.h"
+#include "render/TextCache.h"
+#include "render/TextRenderer.h"
 
-class ClockView {
+class AssetLoader;
+class EventSnapshotSlot;
+class MetaSnapshotSlot;
+
+class ClockView : public LayeredView {
 public:
-    ClockView(SDL_Renderer* renderer, TTF_Font* time_font, TTF_Font* date_font, TTF_Font* info_font, EventStore* store, const std::string& sprite_dir);
-    ~ClockView();
+    ClockView(SDL_Renderer* renderer, TextRenderer* text, FontHandle time_font, FontHandle date_font, FontHandle info_font,
+              const EventSnapshotSlot* events, const MetaSnapshotSlot* sync_status, const MetaSnapshotSlot* weather,
+              const std::string& sprite_dir, AssetLoader* assets = nullptr);
+    ~ClockView() override;
     void Render(int width, int height);
+    LayerChanges Prepare(int width, int height, int64_t now_ts) override;
+    void RenderStatic(int width, int height) override;
+    void RenderDynamic(int width, int height) override;
+    void OnRenderReset(bool device_lost) override;
+    // Forces the next Render to re-read the snapshots, e.g. after a sync finished.
+    void Invalidate();
+    // Shows ":ss" after the minutes and/or blinks the colon once a second.
+    // Either one makes the dynamic layer change every second.
+    void SetSecondsMode(bool show_seconds, bool blink_colon);
+    bool TicksEverySecond() const { return show_seconds_ || blink_colon_; }
 
 private:
     enum class SpriteKind {
@@ -25,43 +46,64 @@ private:
         Count = 5
     };
 
-    struct SpriteTexture {
-        SDL_Texture* texture = nullptr;
-        int w = 0;
-        int h = 0;
-    };
-
-    struct CachedText {
-        std::string text;
-        SDL_Texture* texture = nullptr;
-        int w = 0;
-        int h = 0;
-        SDL_Color color{ 0, 0, 0, 0 };
+    // Glyphs of the big clock, laid out once per face and atlas generation.
+    // The time string is composed from them, so a new time (every second
+    // when seconds are shown) does no UTF-8 decoding, kerning lookups or
+    // rasterisation. Digits sit in equal-width cells so the time does not
+    // shift sideways as they change.
+    struct TimeGlyphs {
+        TTF_Font* font = nullptr;
+        TTF_Font* suffix_font = nullptr;
+        uint32_t generation = 0;
+        std::array<TextLayout, 11> chars;  // '0'-'9', then ':'
+        int digit_w = 0;
+        TextLayout am;
+        TextLayout pm;
     };
 
-    void UpdateCache(int width, int height, int64_t now_ts);
-    void UpdateText(CachedText& cache, TTF_Font* font, const std::string& text, SDL_Color color);
+    bool UpdateCache(int width, int height, int64_t now_ts);
+    bool EnsureTimeGlyphs();
+    bool UpdateTime(int64_t now_ts);
     void ClearCache();
     void LoadSprites();
     void ClearSprites();
     bool DrawSpriteForHour(int hour, const SDL_Rect& area);
     SpriteKind SpriteForHour(int hour) const;
+    // Pixel-art clock for when the sprites are missing. It is rasterised
+    // into a texture only when the minute or size changes, with a single
+    // SDL_RenderFillRects, so other frames draw it as one copy.
+    void DrawClockIcon(int cx, int cy, int radius, int hour, int minute, SDL_Color color);
 
     SDL_Renderer* renderer_;
-    TTF_Font* time_font_;
-    TTF_Font* date_font_;
-    TTF_Font* info_font_;
-    EventStore* store_;
+    TextRenderer* text_;
+    PrimitiveBatch batch_;
+    FontHandle time_font_;
+    FontHandle date_font_;
+    FontHandle info_font_;
+    const EventSnapshotSlot* events_;
+    const MetaSnapshotSlot* sync_status_;
+    const MetaSnapshotSlot* weather_;
     std::string sprite_dir_;
-    bool sprites_loaded_ = false;
-    std::array<SpriteTexture, static_cast<size_t>(SpriteKind::Count)> sprites_{};
+    // Decodes the sprites off the render thread when set.
+    AssetLoader* assets_;
+    SpriteAtlas sprites_;
+    SDL_Texture* clock_icon_ = nullptr;
+    int clock_icon_size_ = 0;
+    // hour * 60 + minute shown by clock_icon_, -1 when it needs redrawing.
+    int clock_icon_key_ = -1;
+    std::vector<SDL_Rect> clock_icon_rects_;
 
     int last_width_ = 0;
     int last_height_ = 0;
     int64_t last_minute_ = -1;
+    int64_t now_ts_ = 0;
 
-    CachedText time_text_;
-    CachedText ampm_text_;
+    bool show_seconds_ = false;
+    bool blink_colon_ = false;
+    TimeGlyphs time_glyphs_;
+    int64_t last_time_key_ = -1;
+    TextLayout time_layout_;
+    const TextLayout* ampm_layout_ = nullptr;
     CachedText date_text_;
     CachedText footer_text_;
     std::array<CachedText, 4> right_texts_;
@@ -1,8 +1,7 @@
 #include "views/WeatherView.h"
 
-#include "db/EventStore.h"
+#include "db/MetaSnapshot.h"
 
-#include <SDL_image.h>
 #include <nlohmann/json.hpp>
 
 #include <algorithm>
@@ -13,8 +12,10 @@
 #include <iostream>
 #include <locale>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 
@@ -42,33 +43,23 @@ WeatherLayout ComputeLayout(int width, int height) {
     return layout;
 }
 
-SDL_Texture* RenderText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, SDL_Color color, int* w, int* h) {
-    SDL_Surface* surface = TTF_RenderUTF8_Blended(font, text.c_str(), color);
-    if (!surface) {
-        std::cerr << "TTF_RenderUTF8_Blended failed: " << TTF_GetError() << "\n";
-        return nullptr;
-    }
-    SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!tex) {
-        std::cerr << "SDL_CreateTextureFromSurface failed: " << SDL_GetError() << "\n";
-        SDL_FreeSurface(surface);
-        return nullptr;
-    }
-    *w = surface->w;
-    *h = surface->h;
-    SDL_FreeSurface(surface);
-    return tex;
+constexpr int kPad = 14;
+
+SDL_Rect TopIconRect(const WeatherLayout& layout) {
+    int icon_size = std::max(72, layout.top.h - 52);
+    return SDL_Rect{
+        layout.top.x + kPad,
+        layout.top.y + 36,
+        std::max(24, std::min(icon_size, layout.top.w / 4)),
+        std::max(24, std::min(icon_size, layout.top.h - 48))
+    };
 }
 
-std::string JoinPath(const std::string& dir, const std::string& file) {
-    if (dir.empty()) {
-        return file;
-    }
-    char last = dir.back();
-    if (last == '/' || last == '\\') {
-        return dir + file;
-    }
-    return dir + "/" + file;
+// Width available to the summary and detail lines right of the icon.
+int InfoMaxWidth(const WeatherLayout& layout) {
+    SDL_Rect icon = TopIconRect(layout);
+    int info_x = icon.x + icon.w + 18;
+    return std::max(32, layout.top.x + layout.top.w - info_x - kPad);
 }
 
 std::string Trim(const std::string& value) {
@@ -145,56 +136,6 @@ std::string FormatDecimal1(double value) {
     return out.str();
 }
 
-std::string TruncateText(TTF_Font* font, const std::string& text, int max_width) {
-    int w = 0;
-    int h = 0;
-    if (TTF_SizeUTF8(font, text.c_str(), &w, &h) == 0 && w <= max_width) {
-        return text;
-    }
-    const std::string ellipsis = "...";
-    for (size_t len = text.size(); len > 0; --len) {
-        std::string candidate = text.substr(0, len) + ellipsis;
-        if (TTF_SizeUTF8(font, candidate.c_str(), &w, &h) == 0 && w <= max_width) {
-            return candidate;
-        }
-    }
-    return ellipsis;
-}
-
-std::string WeatherSpriteKey(int code, bool is_day) {
-    if (code == 0) {
-        return is_day ? "clear" : "clear_night";
-    }
-    if (code == 1) {
-        return "mostly_clear";
-    }
-    if (code == 2) {
-        return "partly_cloudy";
-    }
-    if (code == 3) {
-        return "overcast";
-    }
-    if (code == 45 || code == 48) {
-        return "fog";
-    }
-    if (code >= 51 && code <= 57) {
-        return "drizzle";
-    }
-    if ((code >= 61 && code <= 67) || code == 77) {
-        return "rain";
-    }
-    if (code >= 71 && code <= 75) {
-        return "snow";
-    }
-    if (code >= 80 && code <= 86) {
-        return "showers";
-    }
-    if (code >= 95 && code <= 99) {
-        return "thunder";
-    }
-    return "unknown";
-}
-
 std::string BuildWeatherStatusLine(const std::string& status,
                                    const std::string& sync_ts,
                                    const std::string& error,
@@ -239,17 +180,23 @@ std::string BuildWeatherStatusLine(const std::string& status,
 } // namespace
 
 WeatherView::WeatherView(SDL_Renderer* renderer,
-                         TTF_Font* title_font,
-                         TTF_Font* body_font,
-                         TTF_Font* temp_font,
-                         EventStore* store,
-                         const std::string& sprite_dir)
+                         TextRenderer* text,
+                         FontHandle title_font,
+                         FontHandle body_font,
+                         FontHandle temp_font,
+                         const MetaSnapshotSlot* weather,
+                         const std::string& sprite_dir,
+                         AssetLoader* assets)
     : renderer_(renderer),
+      text_(text),
+      batch_(renderer),
       title_font_(title_font),
       body_font_(body_font),
       temp_font_(temp_font),
-      store_(store),
-      sprite_dir_(sprite_dir) {
+      weather_(weather),
+      sprite_dir_(sprite_dir),
+      assets_(assets),
+      sprites_(renderer) {
     LoadSprites();
 }
 
@@ -258,198 +205,140 @@ WeatherView::~WeatherView() {
     ClearSprites();
 }
 
-void WeatherView::UpdateText(CachedText& cache, TTF_Font* font, const std::string& text, SDL_Color color) {
-    if (text.empty()) {
-        if (cache.texture) {
-            SDL_DestroyTexture(cache.texture);
-            cache.texture = nullptr;
-        }
-        cache.text.clear();
-        cache.w = 0;
-        cache.h = 0;
-        cache.color = color;
-        return;
-    }
-    if (cache.texture &&
-        cache.text == text &&
-        cache.color.r == color.r &&
-        cache.color.g == color.g &&
-        cache.color.b == color.b &&
-        cache.color.a == color.a) {
-        return;
-    }
-    if (cache.texture) {
-        SDL_DestroyTexture(cache.texture);
-        cache.texture = nullptr;
-    }
-    cache.text = text;
-    cache.color = color;
-    cache.texture = RenderText(renderer_, font, text, color, &cache.w, &cache.h);
-}
-
 void WeatherView::ClearCache() {
-    auto destroy = [](CachedText& text) {
-        if (text.texture) {
-            SDL_DestroyTexture(text.texture);
-            text.texture = nullptr;
-        }
+    auto clear = [](CachedText& text) {
+        text.Clear();
     };
 
-    destroy(title_text_);
-    destroy(status_text_);
-    destroy(temp_text_);
-    destroy(summary_text_);
-    destroy(detail_text_);
-    destroy(hourly_title_text_);
-    destroy(weekly_title_text_);
-    destroy(hourly_empty_text_);
-    destroy(daily_empty_text_);
+    clear(title_text_);
+    clear(status_text_);
+    clear(temp_text_);
+    clear(summary_text_);
+    clear(detail_text_);
+    clear(hourly_title_text_);
+    clear(weekly_title_text_);
+    clear(hourly_empty_text_);
+    clear(daily_empty_text_);
 
     for (auto& text : hourly_time_texts_) {
-        destroy(text);
+        clear(text);
     }
     hourly_time_texts_.clear();
     for (auto& text : hourly_temp_texts_) {
-        destroy(text);
+        clear(text);
     }
     hourly_temp_texts_.clear();
     for (auto& text : daily_day_texts_) {
-        destroy(text);
+        clear(text);
     }
     daily_day_texts_.clear();
-    for (auto& text : daily_temp_texts_) {
-        destroy(text);
+    for (auto& text : daily_hi_texts_) {
+        clear(text);
+    }
+    daily_hi_texts_.clear();
+    for (auto& text : daily_lo_texts_) {
+        clear(text);
     }
-    daily_temp_texts_.clear();
+    daily_lo_texts_.clear();
 }
 
 void WeatherView::LoadSprites() {
-    sprites_loaded_ = false;
-    sprites_.clear();
+    sprites_.Clear();
     if (sprite_dir_.empty()) {
         return;
     }
-
-    const std::array<std::pair<const char*, const char*>, 12> files = {{
-        { "clear", "clear.png" },
-        { "clear_night", "clear_night.png" },
-        { "mostly_clear", "mostly_clear.png" },
-        { "partly_cloudy", "partly_cloudy.png" },
-        { "overcast", "overcast.png" },
-        { "fog", "fog.png" },
-        { "drizzle", "drizzle.png" },
-        { "rain", "rain.png" },
-        { "snow", "snow.png" },
-        { "showers", "showers.png" },
-        { "thunder", "thunder.png" },
-        { "unknown", "unknown.png" }
-    }};
-
-    for (const auto& item : files) {
-        std::string path = JoinPath(sprite_dir_, item.second);
-        SDL_Surface* surface = IMG_Load(path.c_str());
-        if (!surface) {
-            continue;
-        }
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
-        if (!texture) {
-            SDL_FreeSurface(surface);
-            continue;
-        }
-        SpriteTexture sprite;
-        sprite.texture = texture;
-        sprite.w = surface->w;
-        sprite.h = surface->h;
-        sprites_[item.first] = sprite;
-        SDL_FreeSurface(surface);
-        sprites_loaded_ = true;
-    }
+    // Same order as WeatherIcon.
+    static const std::vector<std::string> kFiles = {
+        "clear.png",
+        "clear_night.png",
+        "mostly_clear.png",
+        "partly_cloudy.png",
+        "overcast.png",
+        "fog.png",
+        "drizzle.png",
+        "rain.png",
+        "snow.png",
+        "showers.png",
+        "thunder.png",
+        "unknown.png"
+    };
+    static_assert(static_cast<size_t>(WeatherIcon::Count) == 12, "kFiles must list every WeatherIcon");
+    sprites_.LoadAsync(assets_, sprite_dir_, kFiles);
 }
 
 void WeatherView::ClearSprites() {
-    for (auto& [_, sprite] : sprites_) {
-        if (sprite.texture) {
-            SDL_DestroyTexture(sprite.texture);
-            sprite.texture = nullptr;
-        }
-    }
-    sprites_.clear();
-    sprites_loaded_ = false;
+    sprites_.Clear();
 }
 
-bool WeatherView::DrawWeatherSprite(int code, bool is_day, const SDL_Rect& area) {
-    if (!sprites_loaded_) {
-        return false;
+WeatherView::WeatherIcon WeatherView::IconForCode(int code, bool is_day) {
+    if (code == 0) {
+        return is_day ? WeatherIcon::Clear : WeatherIcon::ClearNight;
     }
-    std::string key = WeatherSpriteKey(code, is_day);
-    auto it = sprites_.find(key);
-    if (it == sprites_.end() || !it->second.texture) {
-        it = sprites_.find("unknown");
-        if (it == sprites_.end() || !it->second.texture) {
-            return false;
-        }
+    if (code == 1) {
+        return WeatherIcon::MostlyClear;
     }
-
-    const SpriteTexture& sprite = it->second;
-    int max_w = std::max(1, area.w);
-    int max_h = std::max(1, area.h);
-    float scale = std::min(static_cast<float>(max_w) / std::max(1, sprite.w),
-                           static_cast<float>(max_h) / std::max(1, sprite.h));
-    int draw_w = static_cast<int>(std::round(sprite.w * scale));
-    int draw_h = static_cast<int>(std::round(sprite.h * scale));
-    SDL_Rect dst{
-        area.x + (area.w - draw_w) / 2,
-        area.y + (area.h - draw_h) / 2,
-        draw_w,
-        draw_h
-    };
-    SDL_RenderCopy(renderer_, sprite.texture, nullptr, &dst);
-    return true;
+    if (code == 2) {
+        return WeatherIcon::PartlyCloudy;
+    }
+    if (code == 3) {
+        return WeatherIcon::Overcast;
+    }
+    if (code == 45 || code == 48) {
+        return WeatherIcon::Fog;
+    }
+    if (code >= 51 && code <= 57) {
+        return WeatherIcon::Drizzle;
+    }
+    if ((code >= 61 && code <= 67) || code == 77) {
+        return WeatherIcon::Rain;
+    }
+    if (code >= 71 && code <= 75) {
+        return WeatherIcon::Snow;
+    }
+    if (code >= 80 && code <= 86) {
+        return WeatherIcon::Showers;
+    }
+    if (code >= 95 && code <= 99) {
+        return WeatherIcon::Thunder;
+    }
+    return WeatherIcon::Unknown;
 }
 
-void WeatherView::UpdateCache(int width, int height, int64_t now_ts) {
-    std::string status = store_ ? store_->GetMeta("weather_status") : "";
-    std::string temp_c = store_ ? store_->GetMeta("weather_temp_c") : "";
-    std::string summary = store_ ? store_->GetMeta("weather_summary") : "";
-    std::string wind_kmh = store_ ? store_->GetMeta("weather_wind_kmh") : "";
-    std::string error = store_ ? store_->GetMeta("weather_error") : "";
-    std::string weather_code = store_ ? store_->GetMeta("weather_code") : "";
-    std::string weather_is_day = store_ ? store_->GetMeta("weather_is_day") : "";
-    std::string hourly_json = store_ ? store_->GetMeta("weather_hourly_json") : "";
-    std::string daily_json = store_ ? store_->GetMeta("weather_daily_json") : "";
-    std::string sync_ts = store_ ? store_->GetMeta("weather_last_sync_ts") : "";
+bool WeatherView::DrawWeatherSprite(WeatherIcon icon, const SDL_Rect& area) {
+    if (!sprites_.Has(static_cast<size_t>(icon))) {
+        icon = WeatherIcon::Unknown;
+    }
+    return sprites_.DrawFit(static_cast<size_t>(icon), area);
+}
 
+bool WeatherView::UpdateCache(int width, int height, int64_t now_ts) {
+    // Sync results arrive through Invalidate(), so the snapshot is only read
+    // when the minute (and with it the "Updated Xm ago" line) or the size
+    // changes; an unchanged frame does no queries and no allocations.
     bool size_changed = width != last_width_ || height != last_height_;
     int64_t minute = now_ts / 60;
-    bool minute_changed = minute != last_minute_;
-    bool data_changed = status != last_status_ ||
-                        temp_c != last_temp_c_ ||
-                        summary != last_summary_ ||
-                        wind_kmh != last_wind_kmh_ ||
-                        error != last_error_ ||
-                        weather_code != last_weather_code_ ||
-                        weather_is_day != last_weather_is_day_ ||
-                        hourly_json != last_hourly_json_ ||
-                        daily_json != last_daily_json_ ||
-                        sync_ts != last_sync_ts_;
-
-    if (!size_changed && !minute_changed && !data_changed) {
-        return;
+    if (!size_changed && minute == last_minute_) {
+        return false;
     }
-
     last_width_ = width;
     last_height_ = height;
     last_minute_ = minute;
-    last_status_ = status;
-    last_temp_c_ = temp_c;
-    last_summary_ = summary;
-    last_wind_kmh_ = wind_kmh;
-    last_error_ = error;
-    last_weather_code_ = weather_code;
-    last_weather_is_day_ = weather_is_day;
-    last_hourly_json_ = hourly_json;
-    last_daily_json_ = daily_json;
-    last_sync_ts_ = sync_ts;
+    if (size_changed) {
+        // Icon cells change with the layout; resample for the new sizes.
+        sprites_.ClearScaled();
+    }
+
+    std::shared_ptr<const MetaSnapshot> meta = weather_ ? weather_->Current() : std::make_shared<const MetaSnapshot>();
+    const std::string& status = meta->Get("weather_status");
+    const std::string& temp_c = meta->Get("weather_temp_c");
+    const std::string& summary = meta->Get("weather_summary");
+    const std::string& wind_kmh = meta->Get("weather_wind_kmh");
+    const std::string& error = meta->Get("weather_error");
+    const std::string& weather_code = meta->Get("weather_code");
+    const std::string& weather_is_day = meta->Get("weather_is_day");
+    const std::string& hourly_json = meta->Get("weather_hourly_json");
+    const std::string& daily_json = meta->Get("weather_daily_json");
+    const std::string& sync_ts = meta->Get("weather_last_sync_ts");
 
     hourly_entries_.clear();
     daily_entries_.clear();
@@ -462,8 +351,7 @@ void WeatherView::UpdateCache(int width, int height, int64_t now_ts) {
             }
             HourlyEntry entry;
             entry.time_label = FormatHourLabel(item.value("time", ""));
-            entry.code = item.value("code", -1);
-            entry.is_day = item.value("is_day", 1) == 1;
+            entry.icon = IconForCode(item.value("code", -1), item.value("is_day", 1) == 1);
             if (item.contains("temp_c") && item["temp_c"].is_number()) {
                 entry.temp_label = FormatDecimal1(item.value("temp_c", 0.0)) + " C";
             } else {
@@ -505,22 +393,24 @@ void WeatherView::UpdateCache(int width, int height, int64_t now_ts) {
         }
     }
 
-    current_code_ = -1;
-    current_is_day_ = true;
+    int current_code = -1;
     try {
-        current_code_ = std::stoi(weather_code);
+        current_code = std::stoi(weather_code);
     } catch (const std::exception&) {
-        current_code_ = -1;
+        current_code = -1;
     }
-    current_is_day_ = (weather_is_day != "0");
+    current_icon_ = IconForCode(current_code, weather_is_day != "0");
 
     SDL_Color fg = { 28, 28, 28, 255 };
     SDL_Color dim = { 110, 110, 110, 255 };
 
-    UpdateText(title_text_, title_font_, "Weather", fg);
-    UpdateText(status_text_, body_font_, BuildWeatherStatusLine(status, sync_ts, error, now_ts), dim);
-    UpdateText(temp_text_, temp_font_, temp_c.empty() ? "--" : (temp_c + " C"), fg);
-    UpdateText(summary_text_, body_font_, summary.empty() ? "No weather data" : summary, fg);
+    text_->Cache().Update(&title_text_, title_font_.Get(), "Weather", fg, true);
+    text_->Cache().Update(&status_text_, body_font_.Get(), BuildWeatherStatusLine(status, sync_ts, error, now_ts), dim);
+    text_->Cache().Update(&temp_text_, temp_font_.Get(), temp_c.empty() ? "--" : (temp_c + " C"), fg);
+    int info_max_w = InfoMaxWidth(ComputeLayout(width, height));
+    text_->Cache().Update(&summary_text_, body_font_.Get(),
+                          text_->Measure().Truncate(body_font_.Get(), summary.empty() ? "No weather data" : summary, info_max_w),
+                          fg);
 
     std::string detail = wind_kmh.empty() ? "" : ("Wind " + wind_kmh + " km/h");
     if (!error.empty() && status == "offline") {
@@ -534,143 +424,155 @@ void WeatherView::UpdateCache(int width, int height, int64_t now_ts) {
         }
         detail += "Using cached forecast";
     }
-    UpdateText(detail_text_, body_font_, detail, dim);
-
-    UpdateText(hourly_title_text_, body_font_, "Hourly Forecast", dim);
-    UpdateText(weekly_title_text_, body_font_, "7-Day Forecast", dim);
-    UpdateText(hourly_empty_text_, body_font_, "No hourly forecast yet", dim);
-    UpdateText(daily_empty_text_, body_font_, "No daily forecast yet", dim);
+    text_->Cache().Update(&detail_text_, body_font_.Get(), text_->Measure().Truncate(body_font_.Get(), detail, info_max_w), dim);
 
-    auto reset_list = [](std::vector<CachedText>& list) {
-        for (auto& item : list) {
-            if (item.texture) {
-                SDL_DestroyTexture(item.texture);
-                item.texture = nullptr;
-            }
-        }
-        list.clear();
-    };
-    reset_list(hourly_time_texts_);
-    reset_list(hourly_temp_texts_);
-    reset_list(daily_day_texts_);
-    reset_list(daily_temp_texts_);
+    text_->Cache().Update(&hourly_title_text_, body_font_.Get(), "Hourly Forecast", dim, true);
+    text_->Cache().Update(&weekly_title_text_, body_font_.Get(), "7-Day Forecast", dim, true);
+    text_->Cache().Update(&hourly_empty_text_, body_font_.Get(), "No hourly forecast yet", dim);
+    text_->Cache().Update(&daily_empty_text_, body_font_.Get(), "No daily forecast yet", dim);
 
     hourly_time_texts_.assign(hourly_entries_.size(), CachedText{});
     hourly_temp_texts_.assign(hourly_entries_.size(), CachedText{});
     for (size_t i = 0; i < hourly_entries_.size(); ++i) {
-        UpdateText(hourly_time_texts_[i], body_font_, hourly_entries_[i].time_label, dim);
-        UpdateText(hourly_temp_texts_[i], body_font_, hourly_entries_[i].temp_label, fg);
+        text_->Cache().Update(&hourly_time_texts_[i], body_font_.Get(), hourly_entries_[i].time_label, dim);
+        text_->Cache().Update(&hourly_temp_texts_[i], body_font_.Get(), hourly_entries_[i].temp_label, fg);
     }
 
     daily_day_texts_.assign(daily_entries_.size(), CachedText{});
-    daily_temp_texts_.assign(daily_entries_.size(), CachedText{});
+    daily_hi_texts_.assign(daily_entries_.size(), CachedText{});
+    daily_lo_texts_.assign(daily_entries_.size(), CachedText{});
     for (size_t i = 0; i < daily_entries_.size(); ++i) {
-        UpdateText(daily_day_texts_[i], body_font_, daily_entries_[i].day_label, fg);
-        UpdateText(daily_temp_texts_[i], body_font_, daily_entries_[i].temp_label, dim);
+        const DailyEntry& entry = daily_entries_[i];
+        text_->Cache().Update(&daily_day_texts_[i], body_font_.Get(), entry.day_label, fg);
+
+        // The card shows the high and low on separate lines.
+        std::string hi;
+        std::string lo;
+        size_t slash = entry.temp_label.find('/');
+        if (slash != std::string::npos) {
+            hi = Trim(entry.temp_label.substr(0, slash));
+            lo = Trim(entry.temp_label.substr(slash + 1));
+        } else {
+            hi = entry.temp_label;
+        }
+        if (!hi.empty() && hi.find('H') == std::string::npos) {
+            hi = "H " + hi;
+        }
+        if (!lo.empty() && lo.find('L') == std::string::npos) {
+            lo = "L " + lo;
+        }
+        text_->Cache().Update(&daily_hi_texts_[i], body_font_.Get(), hi, fg);
+        text_->Cache().Update(&daily_lo_texts_[i], body_font_.Get(), lo, dim);
+    }
+    return true;
+}
+
+void WeatherView::Invalidate() {
+    last_minute_ = -1;
+}
+
+void WeatherView::OnRenderReset(bool device_lost) {
+    if (device_lost) {
+        sprites_.RecreateTextures();
     }
 }
 
 void WeatherView::Render(int width, int height) {
-    int64_t now_ts = static_cast<int64_t>(std::time(nullptr));
-    UpdateCache(width, height, now_ts);
+    Prepare(width, height, static_cast<int64_t>(std::time(nullptr)));
+    RenderStatic(width, height);
+    RenderDynamic(width, height);
+}
+
+LayerChanges WeatherView::Prepare(int width, int height, int64_t now_ts) {
+    LayerChanges changes;
+    changes.static_layer = width != last_width_ || height != last_height_;
+    changes.dynamic_layer = UpdateCache(width, height, now_ts);
+    // Sprites finishing their background decode replace the empty frames.
+    changes.dynamic_layer = sprites_.Poll() || changes.dynamic_layer;
+    return changes;
+}
 
+void WeatherView::RenderStatic(int width, int height) {
     WeatherLayout layout = ComputeLayout(width, height);
     SDL_Color line = { 200, 200, 200, 255 };
-    SDL_Color dim = { 110, 110, 110, 255 };
-    SDL_Color fg = { 28, 28, 28, 255 };
-    const int pad = 14;
+    const int pad = kPad;
 
-    SDL_SetRenderDrawColor(renderer_, line.r, line.g, line.b, 255);
-    SDL_RenderDrawRect(renderer_, &layout.panel);
-    SDL_RenderDrawLine(renderer_, layout.panel.x, layout.hourly.y, layout.panel.x + layout.panel.w, layout.hourly.y);
-    SDL_RenderDrawLine(renderer_, layout.panel.x, layout.weekly.y, layout.panel.x + layout.panel.w, layout.weekly.y);
+    batch_.DrawRect(layout.panel, line);
+    batch_.DrawLine(layout.panel.x, layout.hourly.y, layout.panel.x + layout.panel.w, layout.hourly.y, line);
+    batch_.DrawLine(layout.panel.x, layout.weekly.y, layout.panel.x + layout.panel.w, layout.weekly.y, line);
 
-    if (title_text_.texture) {
+    if (!title_text_.Empty()) {
         SDL_Rect dst{ layout.top.x + pad, layout.top.y + 8, title_text_.w, title_text_.h };
-        SDL_RenderCopy(renderer_, title_text_.texture, nullptr, &dst);
+        text_->Draw(*title_text_.layout, dst, title_text_.color);
+    }
+    if (!hourly_title_text_.Empty()) {
+        SDL_Rect dst{ layout.hourly.x + pad, layout.hourly.y + 8, hourly_title_text_.w, hourly_title_text_.h };
+        text_->Draw(*hourly_title_text_.layout, dst, hourly_title_text_.color);
+    }
+    if (!weekly_title_text_.Empty()) {
+        SDL_Rect dst{ layout.weekly.x + pad, layout.weekly.y + 8, weekly_title_text_.w, weekly_title_text_.h };
+        text_->Draw(*weekly_title_text_.layout, dst, weekly_title_text_.color);
     }
-    if (status_text_.texture) {
+
+    batch_.DrawLine(layout.hourly.x + pad, layout.hourly.y + 30, layout.hourly.x + layout.hourly.w - pad, layout.hourly.y + 30, line);
+    batch_.DrawLine(layout.weekly.x + pad, layout.weekly.y + 30, layout.weekly.x + layout.weekly.w - pad, layout.weekly.y + 30, line);
+
+    batch_.Flush();
+    text_->Flush();
+}
+
+void WeatherView::RenderDynamic(int width, int height) {
+    WeatherLayout layout = ComputeLayout(width, height);
+    SDL_Color line = { 200, 200, 200, 255 };
+    SDL_Color dim = { 110, 110, 110, 255 };
+    const int pad = kPad;
+
+    if (!status_text_.Empty()) {
         SDL_Rect dst{
             layout.top.x + layout.top.w - status_text_.w - pad,
             layout.top.y + 8,
             status_text_.w,
             status_text_.h
         };
-        SDL_RenderCopy(renderer_, status_text_.texture, nullptr, &dst);
+        text_->Draw(*status_text_.layout, dst, status_text_.color);
     }
 
-    int icon_size = std::max(72, layout.top.h - 52);
-    SDL_Rect top_icon{
-        layout.top.x + pad,
-        layout.top.y + 36,
-        std::max(24, std::min(icon_size, layout.top.w / 4)),
-        std::max(24, std::min(icon_size, layout.top.h - 48))
-    };
-    if (!DrawWeatherSprite(current_code_, current_is_day_, top_icon)) {
-        SDL_SetRenderDrawColor(renderer_, dim.r, dim.g, dim.b, 255);
-        SDL_RenderDrawRect(renderer_, &top_icon);
+    SDL_Rect top_icon = TopIconRect(layout);
+    if (!DrawWeatherSprite(current_icon_, top_icon)) {
+        batch_.DrawRect(top_icon, dim);
     }
 
     int info_x = top_icon.x + top_icon.w + 18;
-    int info_max_w = std::max(32, layout.top.x + layout.top.w - info_x - pad);
 
-    if (temp_text_.texture) {
+    if (!temp_text_.Empty()) {
         SDL_Rect dst{ info_x, layout.top.y + 30, temp_text_.w, temp_text_.h };
-        SDL_RenderCopy(renderer_, temp_text_.texture, nullptr, &dst);
-    }
-    if (summary_text_.texture) {
-        std::string summary = TruncateText(body_font_, summary_text_.text, info_max_w);
-        if (summary != summary_text_.text) {
-            CachedText tmp;
-            UpdateText(tmp, body_font_, summary, fg);
-            if (tmp.texture) {
-                SDL_Rect dst{ info_x, layout.top.y + 78, tmp.w, tmp.h };
-                SDL_RenderCopy(renderer_, tmp.texture, nullptr, &dst);
-                SDL_DestroyTexture(tmp.texture);
-            }
-        } else {
-            SDL_Rect dst{ info_x, layout.top.y + 78, summary_text_.w, summary_text_.h };
-            SDL_RenderCopy(renderer_, summary_text_.texture, nullptr, &dst);
-        }
+        text_->Draw(*temp_text_.layout, dst, temp_text_.color);
     }
-    if (detail_text_.texture) {
-        std::string detail = TruncateText(body_font_, detail_text_.text, info_max_w);
-        if (detail != detail_text_.text) {
-            CachedText tmp;
-            UpdateText(tmp, body_font_, detail, dim);
-            if (tmp.texture) {
-                SDL_Rect dst{ info_x, layout.top.y + 104, tmp.w, tmp.h };
-                SDL_RenderCopy(renderer_, tmp.texture, nullptr, &dst);
-                SDL_DestroyTexture(tmp.texture);
-            }
-        } else {
-            SDL_Rect dst{ info_x, layout.top.y + 104, detail_text_.w, detail_text_.h };
-            SDL_RenderCopy(renderer_, detail_text_.texture, nullptr, &dst);
-        }
+    if (!summary_text_.Empty()) {
+        SDL_Rect dst{ info_x, layout.top.y + 78, summary_text_.w, summary_text_.h };
+        text_->Draw(*summary_text_.layout, dst, summary_text_.color);
     }
-
-    if (hourly_title_text_.texture) {
-        SDL_Rect dst{ layout.hourly.x + pad, layout.hourly.y + 8, hourly_title_text_.w, hourly_title_text_.h };
-        SDL_RenderCopy(renderer_, hourly_title_text_.texture, nullptr, &dst);
+    if (!detail_text_.Empty()) {
+        SDL_Rect dst{ info_x, layout.top.y + 104, detail_text_.w, detail_text_.h };
+        text_->Draw(*detail_text_.layout, dst, detail_text_.color);
     }
 
+
     SDL_Rect hourly_body{
         layout.hourly.x + pad,
         layout.hourly.y + 30,
         layout.hourly.w - pad * 2,
         layout.hourly.h - 36
     };
-    SDL_SetRenderDrawColor(renderer_, line.r, line.g, line.b, 255);
-    SDL_RenderDrawLine(renderer_, hourly_body.x, hourly_body.y, hourly_body.x + hourly_body.w, hourly_body.y);
     if (hourly_entries_.empty()) {
-        if (hourly_empty_text_.texture) {
+        if (!hourly_empty_text_.Empty()) {
             SDL_Rect dst{
                 hourly_body.x + (hourly_body.w - hourly_empty_text_.w) / 2,
                 hourly_body.y + (hourly_body.h - hourly_empty_text_.h) / 2,
                 hourly_empty_text_.w,
                 hourly_empty_text_.h
             };
-            SDL_RenderCopy(renderer_, hourly_empty_text_.texture, nullptr, &dst);
+            text_->Draw(*hourly_empty_text_.layout, dst, hourly_empty_text_.color);
         }
     } else {
         int cols = std::min<int>(8, hourly_entries_.size());
@@ -683,17 +585,16 @@ void WeatherView::Render(int width, int height) {
                 hourly_body.h
             };
             if (i > 0) {
-                SDL_SetRenderDrawColor(renderer_, line.r, line.g, line.b, 255);
-                SDL_RenderDrawLine(renderer_, cell.x, cell.y + 4, cell.x, cell.y + cell.h - 4);
+                batch_.DrawLine(cell.x, cell.y + 4, cell.x, cell.y + cell.h - 4, line);
             }
-            if (i < static_cast<int>(hourly_time_texts_.size()) && hourly_time_texts_[i].texture) {
+            if (i < static_cast<int>(hourly_time_texts_.size()) && !hourly_time_texts_[i].Empty()) {
                 SDL_Rect dst{
                     cell.x + (cell.w - hourly_time_texts_[i].w) / 2,
                     cell.y + 2,
                     hourly_time_texts_[i].w,
                     hourly_time_texts_[i].h
                 };
-                SDL_RenderCopy(renderer_, hourly_time_texts_[i].texture, nullptr, &dst);
+                text_->Draw(*hourly_time_texts_[i].layout, dst, hourly_time_texts_[i].color);
             }
 
             SDL_Rect icon_rect{
@@ -702,24 +603,20 @@ void WeatherView::Render(int width, int height) {
                 34,
                 std::max(18, cell.h - 58)
             };
-            DrawWeatherSprite(hourly_entries_[i].code, hourly_entries_[i].is_day, icon_rect);
+            DrawWeatherSprite(hourly_entries_[i].icon, icon_rect);
 
-            if (i < static_cast<int>(hourly_temp_texts_.size()) && hourly_temp_texts_[i].texture) {
+            if (i < static_cast<int>(hourly_temp_texts_.size()) && !hourly_temp_texts_[i].Empty()) {
                 SDL_Rect dst{
                     cell.x + (cell.w - hourly_temp_texts_[i].w) / 2,
                     cell.y + cell.h - hourly_temp_texts_[i].h - 2,
                     hourly_temp_texts_[i].w,
                     hourly_temp_texts_[i].h
                 };
-                SDL_RenderCopy(renderer_, hourly_temp_texts_[i].texture, nullptr, &dst);
+                text_->Draw(*hourly_temp_texts_[i].layout, dst, hourly_temp_texts_[i].color);
             }
         }
     }
 
-    if (weekly_title_text_.texture) {
-        SDL_Rect dst{ layout.weekly.x + pad, layout.weekly.y + 8, weekly_title_text_.w, weekly_title_text_.h };
-        SDL_RenderCopy(renderer_, weekly_title_text_.texture, nullptr, &dst);
-    }
 
     SDL_Rect weekly_body{
         layout.weekly.x + pad,
@@ -727,17 +624,15 @@ void WeatherView::Render(int width, int height) {
         layout.weekly.w - pad * 2,
         layout.weekly.h - 34
     };
-    SDL_SetRenderDrawColor(renderer_, line.r, line.g, line.b, 255);
-    SDL_RenderDrawLine(renderer_, weekly_body.x, weekly_body.y, weekly_body.x + weekly_body.w, weekly_body.y);
     if (daily_entries_.empty()) {
-        if (daily_empty_text_.texture) {
+        if (!daily_empty_text_.Empty()) {
             SDL_Rect dst{
                 weekly_body.x + (weekly_body.w - daily_empty_text_.w) / 2,
                 weekly_body.y + (weekly_body.h - daily_empty_text_.h) / 2,
                 daily_empty_text_.w,
                 daily_empty_text_.h
             };
-            SDL_RenderCopy(renderer_, daily_empty_text_.texture, nullptr, &dst);
+            text_->Draw(*daily_empty_text_.layout, dst, daily_empty_text_.color);
         }
     } else {
         int cols = std::min<int>(7, daily_entries_.size());
@@ -752,69 +647,33 @@ void WeatherView::Render(int width, int height) {
                 (i == cols - 1) ? (weekly_body.x + weekly_body.w - (weekly_body.x + i * (card_w + gap))) : card_w,
                 card_h
             };
-            SDL_SetRenderDrawColor(renderer_, card_fill.r, card_fill.g, card_fill.b, 255);
-            SDL_RenderFillRect(renderer_, &card);
-            SDL_SetRenderDrawColor(renderer_, line.r, line.g, line.b, 255);
-            SDL_RenderDrawRect(renderer_, &card);
+            batch_.FillRect(card, card_fill);
+            batch_.DrawRect(card, line);
 
-            if (i < static_cast<int>(daily_day_texts_.size()) && daily_day_texts_[i].texture) {
+            if (i < static_cast<int>(daily_day_texts_.size()) && !daily_day_texts_[i].Empty()) {
                 SDL_Rect dst{
                     card.x + (card.w - daily_day_texts_[i].w) / 2,
                     card.y + 6,
                     daily_day_texts_[i].w,
                     daily_day_texts_[i].h
                 };
-                SDL_RenderCopy(renderer_, daily_day_texts_[i].texture, nullptr, &dst);
+                text_->Draw(*daily_day_texts_[i].layout, dst, daily_day_texts_[i].color);
             }
 
-            if (i < static_cast<int>(daily_entries_.size())) {
-                const DailyEntry& entry = daily_entries_[i];
-                std::string hi;
-                std::string lo;
-                size_t slash = entry.temp_label.find('/');
-                if (slash != std::string::npos) {
-                    hi = Trim(entry.temp_label.substr(0, slash));
-                    lo = Trim(entry.temp_label.substr(slash + 1));
-                } else {
-                    hi = entry.temp_label;
-                }
-                if (!hi.empty() && hi.find('H') == std::string::npos) {
-                    hi = "H " + hi;
-                }
-                if (!lo.empty() && lo.find('L') == std::string::npos) {
-                    lo = "L " + lo;
-                }
-
-                if (!hi.empty()) {
-                    CachedText tmp_hi;
-                    UpdateText(tmp_hi, body_font_, hi, fg);
-                    if (tmp_hi.texture) {
-                        SDL_Rect dst{
-                            card.x + (card.w - tmp_hi.w) / 2,
-                            card.y + card.h - tmp_hi.h - 20,
-                            tmp_hi.w,
-                            tmp_hi.h
-                        };
-                        SDL_RenderCopy(renderer_, tmp_hi.texture, nullptr, &dst);
-                        SDL_DestroyTexture(tmp_hi.texture);
-                    }
-                }
-
-                if (!lo.empty()) {
-                    CachedText tmp_lo;
-                    UpdateText(tmp_lo, body_font_, lo, dim);
-                    if (tmp_lo.texture) {
-                        SDL_Rect dst{
-                            card.x + (card.w - tmp_lo.w) / 2,
-                            card.y + card.h - tmp_lo.h - 6,
-                            tmp_lo.w,
-                            tmp_lo.h
-                        };
-                        SDL_RenderCopy(renderer_, tmp_lo.texture, nullptr, &dst);
-                        SDL_DestroyTexture(tmp_lo.texture);
-                    }
-                }
+            if (i < static_cast<int>(daily_hi_texts_.size()) && !daily_hi_texts_[i].Empty()) {
+                const CachedText& hi = daily_hi_texts_[i];
+                SDL_Rect dst{ card.x + (card.w - hi.w) / 2, card.y + card.h - hi.h - 20, hi.w, hi.h };
+                text_->Draw(*hi.layout, dst, hi.color);
+            }
+            if (i < static_cast<int>(daily_lo_texts_.size()) && !daily_lo_texts_[i].Empty()) {
+                const CachedText& lo = daily_lo_texts_[i];
+                SDL_Rect dst{ card.x + (card.w - lo.w) / 2, card.y + card.h - lo.h - 6, lo.w, lo.h };
+                text_->Draw(*lo.layout, dst, lo.color);
             }
         }
     }
+
+    // The day cards go under their labels.
+    batch_.Flush();
+    text_->Flush();
 }
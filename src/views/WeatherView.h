@@ -5,43 +5,60 @@
 
 #include <cstdint>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
-class EventStore;
+#include "render/FontRegistry.h"
+#include "render/LayeredView.h"
+#include "render/PrimitiveBatch.h"
+#include "render/SpriteAtlas.h"
+#include "render/TextCache.h"
+#include "render/TextRenderer.h"
 
-class WeatherView {
+class AssetLoader;
+class MetaSnapshotSlot;
+
+class WeatherView : public LayeredView {
 public:
     WeatherView(SDL_Renderer* renderer,
-                TTF_Font* title_font,
-                TTF_Font* body_font,
-                TTF_Font* temp_font,
-                EventStore* store,
-                const std::string& sprite_dir);
-    ~WeatherView();
+                TextRenderer* text,
+                FontHandle title_font,
+                FontHandle body_font,
+                FontHandle temp_font,
+                const MetaSnapshotSlot* weather,
+                const std::string& sprite_dir,
+                AssetLoader* assets = nullptr);
+    ~WeatherView() override;
 
     void Render(int width, int height);
+    LayerChanges Prepare(int width, int height, int64_t now_ts) override;
+    void RenderStatic(int width, int height) override;
+    void RenderDynamic(int width, int height) override;
+    void OnRenderReset(bool device_lost) override;
+    // Forces the next Render to re-read the snapshots, e.g. after a sync finished.
+    void Invalidate();
 
 private:
-    struct CachedText {
-        std::string text;
-        SDL_Texture* texture = nullptr;
-        int w = 0;
-        int h = 0;
-        SDL_Color color{ 0, 0, 0, 0 };
-    };
-
-    struct SpriteTexture {
-        SDL_Texture* texture = nullptr;
-        int w = 0;
-        int h = 0;
+    // Sprite atlas index, resolved from the WMO code when the snapshot is read.
+    enum class WeatherIcon {
+        Clear,
+        ClearNight,
+        MostlyClear,
+        PartlyCloudy,
+        Overcast,
+        Fog,
+        Drizzle,
+        Rain,
+        Snow,
+        Showers,
+        Thunder,
+        Unknown,
+        Count
     };
 
     struct HourlyEntry {
         std::string time_label;
         std::string temp_label;
-        int code = -1;
-        bool is_day = true;
+        WeatherIcon icon = WeatherIcon::Unknown;
     };
 
     struct DailyEntry {
@@ -50,40 +67,31 @@ private:
         int code = -1;
     };
 
-    void UpdateCache(int width, int height, int64_t now_ts);
-    void UpdateText(CachedText& cache, TTF_Font* font, const std::string& text, SDL_Color color);
+    bool UpdateCache(int width, int height, int64_t now_ts);
     void ClearCache();
     void LoadSprites();
     void ClearSprites();
-    bool DrawWeatherSprite(int code, bool is_day, const SDL_Rect& area);
+    bool DrawWeatherSprite(WeatherIcon icon, const SDL_Rect& area);
+    static WeatherIcon IconForCode(int code, bool is_day);
 
     SDL_Renderer* renderer_;
-    TTF_Font* title_font_;
-    TTF_Font* body_font_;
-    TTF_Font* temp_font_;
-    EventStore* store_;
+    TextRenderer* text_;
+    PrimitiveBatch batch_;
+    FontHandle title_font_;
+    FontHandle body_font_;
+    FontHandle temp_font_;
+    const MetaSnapshotSlot* weather_;
     std::string sprite_dir_;
+    // Decodes the sprites off the render thread when set.
+    AssetLoader* assets_;
 
-    bool sprites_loaded_ = false;
-    std::unordered_map<std::string, SpriteTexture> sprites_;
+    SpriteAtlas sprites_;
 
     int last_width_ = 0;
     int last_height_ = 0;
     int64_t last_minute_ = -1;
 
-    std::string last_status_;
-    std::string last_temp_c_;
-    std::string last_summary_;
-    std::string last_wind_kmh_;
-    std::string last_error_;
-    std::string last_weather_code_;
-    std::string last_weather_is_day_;
-    std::string last_hourly_json_;
-    std::string last_daily_json_;
-    std::string last_sync_ts_;
-
-    int current_code_ = -1;
-    bool current_is_day_ = true;
+    WeatherIcon current_icon_ = WeatherIcon::Unknown;
     std::vector<HourlyEntry> hourly_entries_;
     std::vector<DailyEntry> daily_entries_;
 
@@ -100,5 +108,6 @@ private:
     std::vector<CachedText> hourly_time_texts_;
     std::vector<CachedText> hourly_temp_texts_;
     std::vector<CachedText> daily_day_texts_;
-    std::vector<CachedText> daily_temp_texts_;
+    std::vector<CachedText> daily_hi_texts_;
+    std::vector<CachedText> daily_lo_texts_;
 };